@@ -54,7 +54,7 @@ project "DynamicBinaryFileLibrary"
 project "DynamicBinaryFileTest"
     kind "ConsoleApp"
     language "C++"
-    cppdialect "C++20"
+    cppdialect "C++latest"
     targetdir "%{wks.location}/bin/"
     objdir "%{wks.location}/obj/"
 
@@ -75,3 +75,64 @@ project "DynamicBinaryFileTest"
     }
     links { "DynamicBinaryFileLibrary" }
     dependson "DynamicBinaryFileLibrary"
+
+    filter { "system:linux" }
+        links { "pthread" }
+    filter {}
+
+project "DynamicBinaryFileBench"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    targetdir "%{wks.location}/bin/"
+    objdir "%{wks.location}/obj/"
+
+    targetname "dbfbench"
+    
+    files {
+        "./src/bench/**.hpp",
+        "./src/bench/**.cpp",
+    }
+
+    includedirs {
+        "src/lib",
+        "src/bench"
+    }
+
+    vpaths {
+        ["*"] = "*"
+    }
+    links { "DynamicBinaryFileLibrary" }
+    dependson "DynamicBinaryFileLibrary"
+
+    filter { "system:linux" }
+        links { "pthread" }
+    filter {}
+
+project "DynamicBinaryFileIngest"
+    kind "ConsoleApp"
+    language "C++"
+    cppdialect "C++20"
+    targetdir "%{wks.location}/bin/"
+    objdir "%{wks.location}/obj/"
+
+    targetname "dbfingest"
+    
+    files {
+        "./src/tools/ingest/**.hpp",
+        "./src/tools/ingest/**.cpp",
+    }
+
+    includedirs {
+        "src/lib"
+    }
+
+    vpaths {
+        ["*"] = "*"
+    }
+    links { "DynamicBinaryFileLibrary" }
+    dependson "DynamicBinaryFileLibrary"
+
+    filter { "system:linux" }
+        links { "pthread" }
+    filter {}
@@ -0,0 +1,99 @@
+#include <dbflib.hpp>
+#include <perf_counters.hpp>
+#include <ring_bench.hpp>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <random>
+
+namespace {
+    struct BenchNode {
+        BenchNode* next;
+        uint64_t payload[7];
+    };
+
+    struct BenchMode {
+        const char* name;
+        std::function<void()> run;
+    };
+
+    void RunMode(dbfbench::PerfCounters& counters, const BenchMode& mode, size_t iterations, size_t links, size_t bytes) {
+        // warm up the file cache
+        mode.run();
+
+        std::array<uint64_t, dbfbench::PC_COUNT> total{};
+        std::chrono::nanoseconds time{};
+        for (size_t i = 0; i < iterations; i++) {
+            auto start = std::chrono::steady_clock::now();
+            counters.Start();
+            mode.run();
+            std::array<uint64_t, dbfbench::PC_COUNT> values = counters.Stop();
+            time += std::chrono::steady_clock::now() - start;
+            for (size_t c = 0; c < dbfbench::PC_COUNT; c++) {
+                total[c] += values[c];
+            }
+        }
+
+        double loads = (double)iterations;
+        std::printf("%-16s %10.2f ns/link %10.4f ns/byte\n", mode.name, (double)time.count() / loads / links, (double)time.count() / loads / bytes);
+        for (size_t c = 0; c < dbfbench::PC_COUNT; c++) {
+            if (!counters.Available((dbfbench::PerfCounter)c)) {
+                std::printf("    %-14s %10s\n", dbfbench::PerfCounterNames[c], "n/a");
+                continue;
+            }
+            std::printf("    %-14s %10.3f /link %10.5f /byte\n", dbfbench::PerfCounterNames[c], total[c] / loads / links, total[c] / loads / bytes);
+        }
+    }
+}
+
+int main(int argc, char const* argv[]) {
+    if (argc > 1 && !std::strcmp(argv[1], "ring")) {
+        size_t messages = argc > 2 ? (size_t)std::strtoull(argv[2], nullptr, 10) : 1000000;
+        dbfbench::RunRingBench(messages ? messages : 1);
+        return 0;
+    }
+
+    size_t iterations = argc > 1 ? (size_t)std::strtoull(argv[1], nullptr, 10) : 20;
+    if (!iterations) {
+        iterations = 1;
+    }
+
+    // one link per node, the destinations are shuffled to measure the cache and tlb misses of the linking
+    constexpr size_t nodes = UINT16_MAX;
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+    std::vector<dbflib::BlockId> ids(nodes);
+    for (size_t i = 0; i < nodes; i++) {
+        ids[i] = builder.CreateBlock<BenchNode>().first;
+    }
+    std::vector<dbflib::BlockId> order{ ids };
+    std::shuffle(order.begin(), order.end(), std::mt19937{ 42 });
+    for (size_t i = 0; i < nodes; i++) {
+        builder.CreateLink(ids[i], offsetof(BenchNode, next), order[i]);
+    }
+    std::filesystem::path path{ std::filesystem::temp_directory_path() / "dbfbench.dbf" };
+    dbflib::DB_FILE* built = builder.Build();
+    std::vector<uint8_t> buffer(reinterpret_cast<uint8_t*>(built), reinterpret_cast<uint8_t*>(built) + built->file_size);
+    builder.WriteToFile(path);
+
+    size_t links = built->links_count;
+    size_t bytes = built->file_size;
+    dbfbench::PerfCounters counters{};
+    std::printf("%zu links, %zu bytes, %zu iterations\n", links, bytes, iterations);
+    if (!counters.AnyAvailable()) {
+        std::printf("hardware counters unavailable, only reporting the time\n");
+    }
+
+    BenchMode modes[]{
+        { "link", [&buffer]() { reinterpret_cast<dbflib::DB_FILE*>(buffer.data())->Link(true); } },
+        { "read", [&path]() { dbflib::DBFileReader reader{ path }; } },
+        { "mmap", [&path]() { dbflib::DBFileReader reader{ path, dbflib::DBFRO_MMAP }; } },
+        { "mmap-populate", [&path]() { dbflib::DBFileReader reader{ path, dbflib::DBFRO_MMAP | dbflib::DBFRO_POPULATE }; } },
+        { "mmap-prefault", [&path]() { dbflib::DBFileReader reader{ path, dbflib::DBFRO_MMAP | dbflib::DBFRO_PREFAULT }; } },
+    };
+    for (const BenchMode& mode : modes) {
+        RunMode(counters, mode, iterations, links, bytes);
+    }
+
+    std::filesystem::remove(path);
+    return 0;
+}
@@ -0,0 +1,136 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+ * Hardware performance counters for the benchmarks
+ */
+namespace dbfbench {
+    enum PerfCounter : size_t {
+        PC_CYCLES = 0,
+        PC_INSTRUCTIONS,
+        PC_LLC_MISSES,
+        PC_DTLB_MISSES,
+        PC_BRANCH_MISSES,
+        PC_COUNT,
+    };
+
+    constexpr const char* PerfCounterNames[PC_COUNT]{
+        "cycles",
+        "instructions",
+        "llc-misses",
+        "dtlb-misses",
+        "branch-misses",
+    };
+
+    /*
+     * Counters of the calling thread, each counter is opened separately, so a counter missing on the machine
+     * (virtual machine, perf_event_paranoid, other os) is only reported as unavailable.
+     */
+    class PerfCounters {
+        std::array<int, PC_COUNT> fds{};
+
+#ifdef __linux__
+        static int Open(uint32_t type, uint64_t config) {
+            perf_event_attr attr{};
+            attr.size = sizeof(attr);
+            attr.type = type;
+            attr.config = config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        }
+
+        static constexpr uint64_t Cache(uint64_t cache, uint64_t op, uint64_t result) {
+            return cache | (op << 8) | (result << 16);
+        }
+#endif
+    public:
+        PerfCounters() {
+            fds.fill(-1);
+#ifdef __linux__
+            fds[PC_CYCLES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+            fds[PC_INSTRUCTIONS] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+            fds[PC_LLC_MISSES] = Open(PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+            fds[PC_DTLB_MISSES] = Open(PERF_TYPE_HW_CACHE, Cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS));
+            fds[PC_BRANCH_MISSES] = Open(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+#endif
+        }
+
+        PerfCounters(PerfCounters& o) = delete;
+        PerfCounters(PerfCounters&& o) = delete;
+
+        ~PerfCounters() {
+#ifdef __linux__
+            for (int fd : fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        /*
+         * @param counter counter
+         * @return true if the counter is available
+         */
+        bool Available(PerfCounter counter) const {
+            return fds[counter] >= 0;
+        }
+
+        /*
+         * @return true if at least one counter is available
+         */
+        bool AnyAvailable() const {
+            for (size_t i = 0; i < PC_COUNT; i++) {
+                if (fds[i] >= 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /*
+         * Reset and start the counters
+         */
+        void Start() {
+#ifdef __linux__
+            for (int fd : fds) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        /*
+         * Stop the counters and read them
+         * @return counter values, 0 for the unavailable counters
+         */
+        std::array<uint64_t, PC_COUNT> Stop() {
+            std::array<uint64_t, PC_COUNT> values{};
+#ifdef __linux__
+            for (size_t i = 0; i < PC_COUNT; i++) {
+                if (fds[i] < 0) {
+                    continue;
+                }
+                ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+                if (read(fds[i], &values[i], sizeof(values[i])) != sizeof(values[i])) {
+                    values[i] = 0;
+                }
+            }
+#endif
+            return values;
+        }
+    };
+}
@@ -0,0 +1,160 @@
+#include <dbflib_ring.hpp>
+#include <ring_bench.hpp>
+#include <chrono>
+#include <cstdio>
+
+#ifdef DBFLIB_POSIX
+#include <sys/wait.h>
+#endif
+
+namespace {
+#ifdef DBFLIB_POSIX
+    struct RingBenchMessage {
+        uint64_t producer;
+        uint64_t index;
+        uint32_t count;
+        dbflib::DBRelPtr<uint64_t> values;
+    };
+
+    constexpr size_t RING_BENCH_VALUES = 16;
+
+    void SendMessage(dbflib::DBSharedRing& ring, uint64_t index, uint64_t producer = 0) {
+        dbflib::DB_RING_MESSAGE message = ring.Reserve();
+        dbflib::DBRingMessageBuilder builder{ message };
+        RingBenchMessage* root = builder.Allocate<RingBenchMessage>();
+        root->producer = producer;
+        root->index = index;
+        root->count = RING_BENCH_VALUES;
+        uint64_t* values = builder.Allocate<uint64_t>(RING_BENCH_VALUES);
+        for (size_t i = 0; i < RING_BENCH_VALUES; i++) {
+            values[i] = index + i;
+        }
+        root->values = values;
+        ring.Commit(message, builder);
+    }
+
+    // read a message, check the order of each producer if next is set
+    uint64_t ReadMessage(dbflib::DBSharedRing& ring, std::vector<uint64_t>* next = nullptr) {
+        dbflib::DB_RING_MESSAGE message = ring.Peek();
+        const RingBenchMessage* root = message.Root<RingBenchMessage>();
+        if (next && (root->producer >= next->size() || root->index != (*next)[root->producer]++)) {
+            std::fprintf(stderr, "bad message order\n");
+            std::exit(1);
+        }
+        uint64_t sum = root->index;
+        for (size_t i = 0; i < root->count; i++) {
+            sum += root->values[i];
+        }
+        ring.Release(message);
+        return sum;
+    }
+
+    // run a function in a child process
+    template<typename Func>
+    pid_t Fork(Func&& func) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::perror("fork");
+            std::exit(1);
+        }
+        if (!pid) {
+            func();
+            _exit(0);
+        }
+        return pid;
+    }
+
+    void Wait(pid_t pid) {
+        int status{};
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status)) {
+            std::fprintf(stderr, "bad child process exit\n");
+            std::exit(1);
+        }
+    }
+#endif
+}
+
+namespace dbfbench {
+    void RunRingBench(size_t messages) {
+#ifdef DBFLIB_POSIX
+        constexpr size_t slotSize = sizeof(RingBenchMessage) + RING_BENCH_VALUES * sizeof(uint64_t);
+        std::printf("%zu messages, %zu bytes per message\n", messages, slotSize);
+
+        {
+            // ping pong between the processes, one ring per direction
+            dbflib::DBSharedRing ping{ 16, slotSize };
+            dbflib::DBSharedRing pong{ 16, slotSize };
+            pid_t pid = Fork([&ping, &pong, messages]() {
+                for (size_t i = 0; i < messages; i++) {
+                    SendMessage(pong, ReadMessage(ping));
+                }
+            });
+
+            std::vector<std::chrono::nanoseconds> times(messages);
+            for (size_t i = 0; i < messages; i++) {
+                auto start = std::chrono::steady_clock::now();
+                SendMessage(ping, i);
+                ReadMessage(pong);
+                times[i] = std::chrono::steady_clock::now() - start;
+            }
+            Wait(pid);
+
+            std::sort(times.begin(), times.end());
+            std::chrono::nanoseconds total{};
+            for (std::chrono::nanoseconds t : times) {
+                total += t;
+            }
+            std::printf("%-18s %10.1f ns avg %10lld ns p50 %10lld ns p99 (round trip)\n", "latency",
+                (double)total.count() / messages, (long long)times[messages / 2].count(), (long long)times[messages * 99 / 100].count());
+        }
+
+        // start flag of the producers, so the process creation isn't measured
+        void* startMapping = mmap(nullptr, sizeof(std::atomic<uint32_t>), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (startMapping == MAP_FAILED) {
+            std::perror("mmap");
+            std::exit(1);
+        }
+        std::atomic<uint32_t>* go = new (startMapping) std::atomic<uint32_t>{};
+
+        for (size_t producers : { 1, 2, 4 }) {
+            dbflib::DBSharedRing ring{ 1024, slotSize, producers > 1 ? (uint32_t)dbflib::DBRF_MULTI_PRODUCER : 0u };
+            size_t perProducer = std::max<size_t>(1, messages / producers);
+            go->store(0, std::memory_order_relaxed);
+            std::vector<pid_t> pids{};
+            for (size_t p = 0; p < producers; p++) {
+                pids.push_back(Fork([&ring, go, perProducer, p]() {
+                    while (!go->load(std::memory_order_acquire)) {
+                        std::this_thread::yield();
+                    }
+                    for (size_t i = 0; i < perProducer; i++) {
+                        SendMessage(ring, i, p);
+                    }
+                }));
+            }
+
+            std::vector<uint64_t> next(producers);
+            uint64_t sum{};
+            auto start = std::chrono::steady_clock::now();
+            go->store(1, std::memory_order_release);
+            for (size_t i = 0; i < perProducer * producers; i++) {
+                sum += ReadMessage(ring, &next);
+            }
+            std::chrono::nanoseconds time = std::chrono::steady_clock::now() - start;
+            for (pid_t pid : pids) {
+                Wait(pid);
+            }
+
+            size_t total = perProducer * producers;
+            double seconds = (double)time.count() / 1e9;
+            char name[32];
+            std::snprintf(name, sizeof(name), producers > 1 ? "throughput-mpsc%zu" : "throughput-spsc", producers);
+            std::printf("%-18s %10.2f Mmsg/s %10.2f GB/s (sum %llu)\n", name,
+                total / seconds / 1e6, total * (double)slotSize / seconds / 1e9, (unsigned long long)sum);
+        }
+        munmap(startMapping, sizeof(std::atomic<uint32_t>));
+#else
+        std::printf("the ring benchmark requires a POSIX system\n");
+#endif
+    }
+}
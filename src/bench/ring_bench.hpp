@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+
+namespace dbfbench {
+    /*
+     * Measure the latency and the throughput of a shared ring between two processes
+     * @param messages messages count of each test
+     */
+    void RunRingBench(size_t messages);
+}
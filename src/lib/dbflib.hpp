@@ -1,9 +1,53 @@
+#pragma once
 #include <vector>
 #include <unordered_map>
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#include <cstddef>
 #include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "dbflib_executor.hpp"
+
+#if __has_include(<expected>)
+#include <expected>
+#endif
+
+#ifdef __cpp_lib_expected
+// std::expected API available
+#define DBFLIB_EXPECTED
+#endif
+
+#ifdef __cpp_exceptions
+#define DBFLIB_THROW(msg) throw std::runtime_error(msg)
+#else
+// built without exceptions, the errors are fatal, the Try* functions can be used to handle them
+#define DBFLIB_THROW(msg) (std::fputs(msg "\n", stderr), std::abort())
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DBFLIB_POSIX
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#ifdef __linux__
+#define DBFLIB_LINUX
+#include <sys/sendfile.h>
+#endif
 
 /*
  * Dynamically linked binary file library
@@ -14,18 +58,65 @@ namespace dbflib {
     // minimum support version 
     constexpr uint8_t DB_FILE_MIN_VERSION = 0x10;
     // current version
-    constexpr uint8_t DB_FILE_CURR_VERSION = 0x11;
+    constexpr uint8_t DB_FILE_CURR_VERSION = 0x12;
 
     static_assert(DB_FILE_MIN_VERSION <= DB_FILE_CURR_VERSION && "Minimum version should be lower or equal to the current version");
 
     enum DB_FILE_VERSION_FEATURE : uint8_t {
         LINKING = 0x10,
         FAST_LINKING = 0x11,
+        EXTENSIONS = 0x12,
+    };
+
+    enum DB_FILE_EXTENSION_TYPE : uint32_t {
+        // DB_FILE_SECTION array, the links are sorted by section
+        DBFE_SECTIONS = 1,
+        // DB_FILE_BLOCK array, sorted by offset
+        DBFE_BLOCKS = 2,
+        // DB_FILE_BLOCK_TYPE_TABLE, the typed blocks grouped by type
+        DBFE_BLOCK_TYPES = 3,
+        // DB_FILE_SYMBOL_LINK array, sorted by origin
+        DBFE_SYMBOLS = 4,
     };
 
     enum DB_FILE_BUILDER_OPTIONS : uint8_t {
         // 64 bits align all new blocks
         DBFBO_ALIGN = 1,
+        // store the block table in the DBFE_BLOCKS extension and the typed blocks in the DBFE_BLOCK_TYPES extension
+        DBFBO_BLOCK_TABLE = 2,
+    };
+
+    enum DB_FILE_WRITE_OPTIONS : uint32_t {
+        // map the pages into the pipe with vmsplice/splice instead of copying them, the builder and the views should stay
+        // unchanged until the receiver has read the file
+        DBFWO_ZERO_COPY = 1,
+        // leave the all zero pages as holes when writing into a regular file
+        DBFWO_SPARSE = 2,
+    };
+
+    enum DB_FILE_READER_OPTIONS : uint32_t {
+        // map the file with a private mapping instead of reading it, the links are only written in the process memory
+        DBFRO_MMAP = 1,
+        // populate the mapping when mapping the file (MAP_POPULATE)
+        DBFRO_POPULATE = 2,
+        // touch all the pages of the file in parallel before linking it
+        DBFRO_PREFAULT = 4,
+        // lock the file in memory
+        DBFRO_MLOCK = 8,
+    };
+
+    /*
+     * Time spent by a reader to load a file
+     */
+    struct DB_FILE_READER_STATS {
+        // read or map the file
+        std::chrono::nanoseconds load{};
+        // touch the pages
+        std::chrono::nanoseconds prefault{};
+        // lock the pages
+        std::chrono::nanoseconds lock{};
+        // validate and link the file
+        std::chrono::nanoseconds link{};
     };
 
     typedef uint32_t BlockId;
@@ -37,6 +128,207 @@ namespace dbflib {
         uint32_t destination;
     };
 
+    enum DB_FILE_ERROR_CODE : uint32_t {
+        DBFEC_OK = 0,
+        DBFEC_FILE_TOO_SMALL,
+        DBFEC_BAD_MAGIC,
+        DBFEC_VERSION_TOO_LOW,
+        DBFEC_READ_FILE_TOO_SMALL,
+        DBFEC_START_AFTER_END,
+        DBFEC_LINKS_TABLE_AFTER_END,
+        DBFEC_EXTENSION_TABLE_AFTER_END,
+        DBFEC_EXTENSION_AFTER_END,
+        DBFEC_LINK_AFTER_END,
+        DBFEC_CANT_OPEN,
+        DBFEC_CANT_READ,
+        DBFEC_SYMBOL_AFTER_END,
+        DBFEC_UNRESOLVED_SYMBOL,
+    };
+
+    /*
+     * File error, without allocation
+     */
+    struct DbfError {
+        DB_FILE_ERROR_CODE code{};
+        // file offset of the invalid field
+        uint32_t offset{};
+
+        /*
+         * @return static error message
+         */
+        constexpr const char* Message() const {
+            switch (code) {
+            case DBFEC_OK: return "no error";
+            case DBFEC_FILE_TOO_SMALL: return "invalid file: file too small";
+            case DBFEC_BAD_MAGIC: return "invalid file: bad magic";
+            case DBFEC_VERSION_TOO_LOW: return "invalid file: version too low";
+            case DBFEC_READ_FILE_TOO_SMALL: return "invalid file: read file too small";
+            case DBFEC_START_AFTER_END: return "invalid file: start offset after file end";
+            case DBFEC_LINKS_TABLE_AFTER_END: return "invalid file: links table after file end";
+            case DBFEC_EXTENSION_TABLE_AFTER_END: return "invalid file: extension table after file end";
+            case DBFEC_EXTENSION_AFTER_END: return "invalid file: extension after file end";
+            case DBFEC_LINK_AFTER_END: return "invalid file: link after end file";
+            case DBFEC_CANT_OPEN: return "can't open input file";
+            case DBFEC_CANT_READ: return "can't read input file";
+            case DBFEC_SYMBOL_AFTER_END: return "invalid file: symbol link after end file";
+            case DBFEC_UNRESOLVED_SYMBOL: return "unresolved symbol";
+            default: return "unknown error";
+            }
+        }
+    };
+
+    /*
+     * Extension table entry, the extensions are optional data sections ignored by the older readers
+     */
+    struct DB_FILE_EXTENSION {
+        uint32_t type;
+        uint32_t offset;
+        uint32_t size;
+        uint32_t __pad;
+    };
+
+    struct DB_FILE_EXTENSION_TABLE {
+        uint32_t count;
+        uint32_t __pad;
+        DB_FILE_EXTENSION extensions[1];
+    };
+
+    /*
+     * Section of a file, the links with an origin in [begin, end) are stored in [first_link, first_link + links_count).
+     * The section 0 is containing the links outside of the other sections.
+     */
+    struct DB_FILE_SECTION {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t first_link;
+        uint32_t links_count;
+        uint32_t priority;
+        uint32_t __pad;
+    };
+
+    /*
+     * Block of a file, stored in the DBFE_BLOCKS extension
+     */
+    struct DB_FILE_BLOCK {
+        uint32_t offset;
+        uint32_t size;
+    };
+
+    /*
+     * Blocks of a type, stored in [first, first + count) of the blocks following the types
+     */
+    struct DB_FILE_BLOCK_TYPE {
+        uint32_t type;
+        uint32_t first;
+        uint32_t count;
+        uint32_t __pad;
+    };
+
+    /*
+     * Typed blocks, the types are sorted by type and followed by the blocks sorted by type and offset
+     */
+    struct DB_FILE_BLOCK_TYPE_TABLE {
+        uint32_t count;
+        uint32_t __pad;
+        DB_FILE_BLOCK_TYPE types[1];
+    };
+
+    /*
+     * Link to a host symbol, the pointer at origin is set to the symbol registered with this hash
+     */
+    struct DB_FILE_SYMBOL_LINK {
+        uint32_t origin;
+        uint32_t __pad;
+        uint64_t hash;
+    };
+
+    /*
+     * Hash a symbol name (FNV-1a)
+     * @param name symbol name
+     * @return symbol hash
+     */
+    constexpr uint64_t SymbolHash(std::string_view name) noexcept {
+        uint64_t hash = 0xcbf29ce484222325;
+        for (char c : name) {
+            hash = (hash ^ (uint8_t)c) * 0x100000001b3;
+        }
+        return hash;
+    }
+
+    /*
+     * Host symbols bound to the symbol links of a file when linking it, the symbols are found by name hash
+     */
+    class DBSymbolRegistry {
+        std::unordered_map<uint64_t, std::pair<std::string, const void*>> symbols{};
+    public:
+        /*
+         * Register a symbol, the same name can be registered again with the same address
+         * @param name symbol name
+         * @param address symbol address
+         */
+        void Register(std::string_view name, const void* address) {
+            auto [it, inserted] = symbols.try_emplace(SymbolHash(name), name, address);
+            if (!inserted && (it->second.first != name || it->second.second != address)) {
+                DBFLIB_THROW(it->second.first != name ? "symbol hash collision" : "symbol already registered");
+            }
+        }
+
+        /*
+         * Register a function
+         * @param name symbol name
+         * @param func function
+         */
+        template<typename Func>
+            requires std::is_function_v<Func>
+        void Register(std::string_view name, Func* func) {
+            Register(name, reinterpret_cast<const void*>(func));
+        }
+
+        /*
+         * Register the vtable of a polymorphic type, read from the vtable pointer at the start of an object. The files
+         * can then contain objects of this type with a symbol link at offset 0, the type should only have one vtable
+         * pointer (no multiple or virtual inheritance).
+         * @param Type polymorphic type
+         * @param name symbol name
+         * @param object object of this type
+         */
+        template<typename Type>
+        void RegisterVTable(std::string_view name, const Type& object) {
+            static_assert(std::is_polymorphic_v<Type> && "RegisterVTable requires a polymorphic type");
+            const void* vtable;
+            std::memcpy(&vtable, &object, sizeof(vtable));
+            Register(name, vtable);
+        }
+
+        /*
+         * Register the vtable of a default constructible polymorphic type
+         * @param Type polymorphic type
+         * @param name symbol name
+         */
+        template<typename Type>
+        void RegisterVTable(std::string_view name) {
+            Type object{};
+            RegisterVTable<Type>(name, object);
+        }
+
+        /*
+         * Find a symbol
+         * @param hash symbol hash
+         * @return symbol address, null if not registered
+         */
+        const void* Find(uint64_t hash) const noexcept {
+            auto it = symbols.find(hash);
+            return it == symbols.end() ? nullptr : it->second.second;
+        }
+
+        /*
+         * @return registered symbols count
+         */
+        size_t Size() const {
+            return symbols.size();
+        }
+    };
+
     struct DB_FILE {
         uint8_t magic[sizeof(decltype(DB_FILE_MAGIC))]{};
         uint8_t version{};
@@ -46,7 +338,7 @@ namespace dbflib {
         uint32_t start_offset{};
         uint32_t data_size{};
         uint32_t file_size{};
-        uint32_t __pad{};
+        uint32_t extensions_offset{};
         void* last_link{};
 
         template<typename StartType = void>
@@ -55,29 +347,172 @@ namespace dbflib {
         }
 
         /*
-         * Validate the file
+         * Validate the file without throwing
          * @param len file size, 0 for unknown
+         * @param error output error
+         * @return true if the file is valid
          */
-        void Validate(size_t len = 0) const {
+        bool Check(size_t len, DbfError& error) const noexcept {
+            auto fail = [&error](DB_FILE_ERROR_CODE code, size_t offset) {
+                error = DbfError{ code, (uint32_t)offset };
+                return false;
+            };
+
             if (len && len < offsetof(DB_FILE, file_size) + sizeof(sizeof(file_size))) {
-                throw std::runtime_error("invalid file: file too small");
+                return fail(DBFEC_FILE_TOO_SMALL, 0);
             }
 
-            if (*reinterpret_cast<decltype(DB_FILE_MAGIC)*>(magic) != DB_FILE_MAGIC) {
-                throw std::runtime_error("invalid file: bad magic");
+            if (*reinterpret_cast<const decltype(DB_FILE_MAGIC)*>(magic) != DB_FILE_MAGIC) {
+                return fail(DBFEC_BAD_MAGIC, offsetof(DB_FILE, magic));
             }
 
             if (version < DB_FILE_MIN_VERSION) {
-                throw std::runtime_error("invalid file: version too low");
+                return fail(DBFEC_VERSION_TOO_LOW, offsetof(DB_FILE, version));
             }
 
             if (len && file_size > len) {
-                throw std::runtime_error("invalid file: read file too small");
+                return fail(DBFEC_READ_FILE_TOO_SMALL, offsetof(DB_FILE, file_size));
             }
 
             if (start_offset > file_size) {
-                throw std::runtime_error("invalid file: start offset after file end");
+                return fail(DBFEC_START_AFTER_END, offsetof(DB_FILE, start_offset));
+            }
+
+            if (version >= DB_FILE_VERSION_FEATURE::LINKING && (size_t)links_table_offset + (size_t)links_count * sizeof(DB_FILE_LINK) > file_size) {
+                return fail(DBFEC_LINKS_TABLE_AFTER_END, offsetof(DB_FILE, links_table_offset));
+            }
+
+            if (version >= DB_FILE_VERSION_FEATURE::EXTENSIONS && extensions_offset) {
+                if ((size_t)extensions_offset + offsetof(DB_FILE_EXTENSION_TABLE, extensions) > file_size) {
+                    return fail(DBFEC_EXTENSION_TABLE_AFTER_END, offsetof(DB_FILE, extensions_offset));
+                }
+                const DB_FILE_EXTENSION_TABLE* table = reinterpret_cast<const DB_FILE_EXTENSION_TABLE*>(magic + extensions_offset);
+                if ((size_t)extensions_offset + offsetof(DB_FILE_EXTENSION_TABLE, extensions) + (size_t)table->count * sizeof(DB_FILE_EXTENSION) > file_size) {
+                    return fail(DBFEC_EXTENSION_TABLE_AFTER_END, extensions_offset);
+                }
+                for (size_t i = 0; i < table->count; i++) {
+                    if ((size_t)table->extensions[i].offset + table->extensions[i].size > file_size) {
+                        return fail(DBFEC_EXTENSION_AFTER_END, extensions_offset + offsetof(DB_FILE_EXTENSION_TABLE, extensions) + i * sizeof(DB_FILE_EXTENSION));
+                    }
+                }
+            }
+            return true;
+        }
+
+        /*
+         * Validate the file
+         * @param len file size, 0 for unknown
+         */
+        void Validate(size_t len = 0) const {
+            DbfError error;
+            if (!Check(len, error)) {
+                ThrowError(error);
+            }
+        }
+
+#ifdef DBFLIB_EXPECTED
+        /*
+         * Validate the file without throwing
+         * @param len file size, 0 for unknown
+         * @return error if the file is invalid
+         */
+        std::expected<void, DbfError> TryValidate(size_t len = 0) const noexcept {
+            DbfError error;
+            if (!Check(len, error)) {
+                return std::unexpected(error);
+            }
+            return {};
+        }
+
+        /*
+         * Link the file without throwing
+         * @param force force the linking
+         * @return if the file was linked or the invalid link
+         */
+        std::expected<bool, DbfError> TryLink(bool force = false) noexcept {
+            if (!StartLink(force)) {
+                return false;
             }
+            DbfError error;
+            if (version >= DB_FILE_VERSION_FEATURE::LINKING && !LinkRange(0, links_count, error)) {
+                return std::unexpected(error);
+            }
+            return true;
+        }
+#endif
+
+        /*
+         * Get an extension of the file
+         * @param ExtensionType pointer type to return
+         * @param type extension type, described in DB_FILE_EXTENSION_TYPE
+         * @param size output extension size, can be null
+         * @return extension pointer, null if the file doesn't contain this extension
+         */
+        template<typename ExtensionType = void>
+        ExtensionType* GetExtension(uint32_t type, size_t* size = nullptr) {
+            if (version < DB_FILE_VERSION_FEATURE::EXTENSIONS || !extensions_offset) {
+                return nullptr;
+            }
+            DB_FILE_EXTENSION_TABLE* table = reinterpret_cast<DB_FILE_EXTENSION_TABLE*>(magic + extensions_offset);
+            for (size_t i = 0; i < table->count; i++) {
+                if (table->extensions[i].type == type) {
+                    if (size) {
+                        *size = table->extensions[i].size;
+                    }
+                    return reinterpret_cast<ExtensionType*>(magic + table->extensions[i].offset);
+                }
+            }
+            return nullptr;
+        }
+
+        /*
+         * Get the blocks of a type, stored with the DBFBO_BLOCK_TABLE builder option
+         * @param type block type, set with the builder SetBlockType method
+         * @return blocks sorted by offset, empty if the file doesn't contain this type
+         */
+        std::span<const DB_FILE_BLOCK> GetBlocksOfType(uint32_t type) {
+            size_t size{};
+            const DB_FILE_BLOCK_TYPE_TABLE* table = GetExtension<const DB_FILE_BLOCK_TYPE_TABLE>(DBFE_BLOCK_TYPES, &size);
+            if (!table) {
+                return {};
+            }
+            size_t headerSize = offsetof(DB_FILE_BLOCK_TYPE_TABLE, types) + (size_t)table->count * sizeof(DB_FILE_BLOCK_TYPE);
+            if (size < headerSize) {
+                DBFLIB_THROW("invalid block types table");
+            }
+            const DB_FILE_BLOCK_TYPE* end = table->types + table->count;
+            const DB_FILE_BLOCK_TYPE* it = std::lower_bound(table->types, end, type, [](const DB_FILE_BLOCK_TYPE& t, uint32_t v) { return t.type < v; });
+            if (it == end || it->type != type) {
+                return {};
+            }
+            if (headerSize + ((size_t)it->first + it->count) * sizeof(DB_FILE_BLOCK) > size) {
+                DBFLIB_THROW("invalid block types table");
+            }
+            const DB_FILE_BLOCK* blocks = reinterpret_cast<const DB_FILE_BLOCK*>(reinterpret_cast<const uint8_t*>(table) + headerSize);
+            return { blocks + it->first, it->count };
+        }
+
+        /*
+         * Run a function on the blocks of a type in parallel
+         * @param BlockType block type
+         * @param type block type, set with the builder SetBlockType method
+         * @param func function (BlockType* block, size_t size), called concurrently
+         * @param executor executor
+         * @param grain min blocks per task
+         */
+        template<typename BlockType = void, typename Func>
+        void ForEachBlockOfType(uint32_t type, Func&& func, DBExecutor& executor = DefaultExecutor(), size_t grain = 64) {
+            std::span<const DB_FILE_BLOCK> blocks = GetBlocksOfType(type);
+            for (const DB_FILE_BLOCK& block : blocks) {
+                if ((size_t)block.offset + block.size > file_size) {
+                    DBFLIB_THROW("invalid block types table");
+                }
+            }
+            ParallelFor(executor, blocks.size(), grain, [this, &blocks, &func](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    func(reinterpret_cast<BlockType*>(magic + blocks[i].offset), (size_t)blocks[i].size);
+                }
+            });
         }
 
         /*
@@ -86,43 +521,352 @@ namespace dbflib {
          * @return if the file was linked
          */
         bool Link(bool force = false) {
-            if (!force && version >= DB_FILE_VERSION_FEATURE::FAST_LINKING) {
-                // store the last pointer to avoid linking the file more than once at the same location
-                if (last_link == (void*)this) {
+            if (!StartLink(force)) {
+                return false;
+            }
+            if (version >= DB_FILE_VERSION_FEATURE::LINKING) {
+                LinkRange(0, links_count);
+            }
+            return true;
+        }
+
+        /*
+         * Link the file, the links table is split between the executor threads
+         * @param executor executor
+         * @param force force the linking
+         * @param grain min links count per task
+         * @return if the file was linked
+         */
+        bool Link(DBExecutor& executor, bool force = false, size_t grain = 0x1000) {
+            if (!StartLink(force)) {
+                return false;
+            }
+            if (version >= DB_FILE_VERSION_FEATURE::LINKING) {
+                ParallelFor(executor, links_count, grain, [this](size_t begin, size_t end) { LinkRange(begin, end); });
+            }
+            return true;
+        }
+
+        /*
+         * Link the file and bind its symbol links
+         * @param registry host symbols
+         * @param force force the linking
+         * @return if the file was linked
+         */
+        bool Link(const DBSymbolRegistry& registry, bool force = false) {
+            if (!Link(force)) {
+                return false;
+            }
+            BindSymbols(registry);
+            return true;
+        }
+
+        /*
+         * Bind the symbol links of the file, stored in the DBFE_SYMBOLS extension, can be called again to rebind them
+         * @param registry host symbols
+         */
+        void BindSymbols(const DBSymbolRegistry& registry) {
+            DbfError error;
+            if (!BindSymbols(registry, error)) {
+                ThrowError(error);
+            }
+        }
+
+        /*
+         * Bind the symbol links of the file without throwing
+         * @param registry host symbols
+         * @param error output error, the offset is the offset of the invalid symbol link
+         * @return true if all the symbols were resolved
+         */
+        bool BindSymbols(const DBSymbolRegistry& registry, DbfError& error) noexcept {
+            size_t size{};
+            DB_FILE_SYMBOL_LINK* symbols = GetExtension<DB_FILE_SYMBOL_LINK>(DBFE_SYMBOLS, &size);
+            if (!symbols) {
+                return true;
+            }
+            for (size_t i = 0; i < size / sizeof(DB_FILE_SYMBOL_LINK); i++) {
+                uint32_t offset = (uint32_t)(reinterpret_cast<uint8_t*>(symbols + i) - magic);
+                if ((size_t)symbols[i].origin + sizeof(void*) > file_size) {
+                    error = DbfError{ DBFEC_SYMBOL_AFTER_END, offset };
                     return false;
                 }
-                last_link = (void*)this;
+                const void* address = registry.Find(symbols[i].hash);
+                if (!address) {
+                    error = DbfError{ DBFEC_UNRESOLVED_SYMBOL, offset };
+                    return false;
+                }
+                std::memcpy(magic + symbols[i].origin, &address, sizeof(address));
             }
-            if (version >= DB_FILE_VERSION_FEATURE::LINKING) {
-                DB_FILE_LINK* links = reinterpret_cast<DB_FILE_LINK*>(magic + links_table_offset);
-                for (size_t i = 0; i < links_count; i++) {
-                    DB_FILE_LINK& link = links[i];
+            return true;
+        }
+
+        /*
+         * Link a range of the links table, without checking if the file was already linked
+         * @param begin first link
+         * @param end end link, exclusive
+         */
+        void LinkRange(size_t begin, size_t end) {
+            DbfError error;
+            if (!LinkRange(begin, end, error)) {
+                ThrowError(error);
+            }
+        }
 
-                    if (link.origin > file_size) throw std::runtime_error("invalid file: link after end file");
-                    if (link.destination > file_size) throw std::runtime_error("invalid file: link after end file");
+        /*
+         * Link a range of the links table without throwing
+         * @param begin first link
+         * @param end end link, exclusive
+         * @param error output error, the offset is the offset of the invalid link
+         * @return true if the links are valid
+         */
+        bool LinkRange(size_t begin, size_t end, DbfError& error) noexcept {
+            DB_FILE_LINK* links = reinterpret_cast<DB_FILE_LINK*>(magic + links_table_offset);
+            for (size_t i = begin; i < end; i++) {
+                DB_FILE_LINK& link = links[i];
 
-                    *reinterpret_cast<void**>(magic + link.origin) = magic + link.destination;
+                if (link.origin > file_size || link.destination > file_size) {
+                    error = DbfError{ DBFEC_LINK_AFTER_END, (uint32_t)(links_table_offset + i * sizeof(DB_FILE_LINK)) };
+                    return false;
+                }
+
+                *reinterpret_cast<void**>(magic + link.origin) = magic + link.destination;
+            }
+            return true;
+        }
+
+    private:
+        [[noreturn]] static void ThrowError(const DbfError& error) {
+#ifdef __cpp_exceptions
+            throw std::runtime_error(error.Message());
+#else
+            std::fputs(error.Message(), stderr);
+            std::fputc('\n', stderr);
+            std::abort();
+#endif
+        }
+
+        bool StartLink(bool force) noexcept {
+            if (!force && version >= DB_FILE_VERSION_FEATURE::FAST_LINKING) {
+                // store the last pointer to avoid linking the file more than once at the same location
+                if (last_link == (void*)this) {
+                    return false;
                 }
+                last_link = (void*)this;
             }
             return true;
         }
     };
 
     class DBFileBuilder {
+        // block referencing a caller buffer, inserted in the file before data[data_offset], the pad bytes at
+        // data[data_offset] aren't written, they keep the data indices aligned like the file offsets
+        struct BlockView {
+            size_t offset;
+            size_t data_offset;
+            const uint8_t* buffer;
+            size_t len;
+            size_t pad;
+        };
+
+        // alignment of the data indices relative to the file offsets
+        static constexpr size_t DATA_ALIGNMENT = alignof(std::max_align_t);
+
         bool linked{};
         uint8_t flags{};
         std::vector<uint8_t> data{};
+        std::vector<BlockView> views{};
+        size_t viewsSize{};
+        size_t viewsPad{};
         std::unordered_map<BlockId, BlockSize> blocks{};
+        std::unordered_map<BlockId, uint32_t> blockTypes{};
         std::vector<DB_FILE_LINK> links{};
+        std::vector<DB_FILE_SYMBOL_LINK> symbols{};
+        // explicit sections, the section 0 is added when building the file
+        std::vector<DB_FILE_SECTION> sections{};
+        bool sectionOpen{};
+        std::vector<std::pair<uint32_t, std::vector<uint8_t>>> extensions{};
 
         DB_FILE* Header() {
             return reinterpret_cast<DB_FILE*>(data.data());
         }
 
+        // size of the file with the views
+        size_t FileSize() const {
+            return data.size() - viewsPad + viewsSize;
+        }
+
+        // find the view containing or preceding a file offset, nullptr if none
+        const BlockView* FindView(size_t offset) const {
+            auto it = std::upper_bound(views.begin(), views.end(), offset, [](size_t off, const BlockView& v) { return off < v.offset; });
+            if (it == views.begin()) {
+                return nullptr;
+            }
+            return &*(it - 1);
+        }
+
+        /*
+         * Finalize the header and the links table without inserting the views in the data
+         */
+        void Finalize() {
+            if (linked) {
+                return;
+            }
+            if (sectionOpen) {
+                DBFLIB_THROW("section not ended");
+            }
+            linked = true;
+            if (!sections.empty()) {
+                SortLinksBySection();
+            }
+            if (flags & DB_FILE_BUILDER_OPTIONS::DBFBO_BLOCK_TABLE) {
+                std::vector<DB_FILE_BLOCK> table{};
+                table.reserve(blocks.size());
+                for (const auto& [id, size] : blocks) {
+                    table.emplace_back(id, size);
+                }
+                std::sort(table.begin(), table.end(), [](const DB_FILE_BLOCK& a, const DB_FILE_BLOCK& b) { return a.offset < b.offset; });
+                SetExtension(DBFE_BLOCKS, table.data(), table.size() * sizeof(table[0]));
+
+                if (!blockTypes.empty()) {
+                    std::vector<DB_FILE_BLOCK_TYPE> types{};
+                    std::vector<std::pair<uint32_t, DB_FILE_BLOCK>> typed{};
+                    typed.reserve(blockTypes.size());
+                    for (const auto& [id, type] : blockTypes) {
+                        typed.emplace_back(type, DB_FILE_BLOCK{ id, GetBlockSize(id) });
+                    }
+                    std::sort(typed.begin(), typed.end(), [](const auto& a, const auto& b) {
+                        return a.first != b.first ? a.first < b.first : a.second.offset < b.second.offset;
+                    });
+                    for (size_t i = 0; i < typed.size(); i++) {
+                        if (types.empty() || types.back().type != typed[i].first) {
+                            types.emplace_back(typed[i].first, (uint32_t)i, 0, 0);
+                        }
+                        types.back().count++;
+                    }
+                    uint32_t count[2]{ (uint32_t)types.size(), 0 };
+                    std::vector<uint8_t> payload{ reinterpret_cast<uint8_t*>(count), reinterpret_cast<uint8_t*>(count) + sizeof(count) };
+                    payload.insert(payload.end(), reinterpret_cast<uint8_t*>(types.data()), reinterpret_cast<uint8_t*>(types.data() + types.size()));
+                    for (const auto& [type, block] : typed) {
+                        payload.insert(payload.end(), reinterpret_cast<const uint8_t*>(&block), reinterpret_cast<const uint8_t*>(&block + 1));
+                    }
+                    SetExtension(DBFE_BLOCK_TYPES, payload.data(), payload.size());
+                }
+            }
+            if (!symbols.empty()) {
+                std::sort(symbols.begin(), symbols.end(), [](const DB_FILE_SYMBOL_LINK& a, const DB_FILE_SYMBOL_LINK& b) { return a.origin < b.origin; });
+                SetExtension(DBFE_SYMBOLS, symbols.data(), symbols.size() * sizeof(symbols[0]));
+            }
+            size_t dataSize{ FileSize() - Header()->start_offset };
+            size_t linksOffset{ FileSize() };
+            if (!links.empty()) {
+                // insert links
+                size_t len = sizeof(links[0]) * links.size();
+                if (linksOffset + len > INT32_MAX) {
+                    DBFLIB_THROW("file too big");
+                }
+                data.insert(data.end(), reinterpret_cast<uint8_t*>(links.data()), reinterpret_cast<uint8_t*>(links.data()) + len);
+            }
+
+            size_t extensionsOffset{};
+            if (!extensions.empty()) {
+                std::vector<DB_FILE_EXTENSION> table{};
+                for (const auto& [type, payload] : extensions) {
+                    data.resize(data.size() + ((8 - FileSize() % 8) % 8));
+                    table.emplace_back(type, (uint32_t)FileSize(), (uint32_t)payload.size(), 0);
+                    data.insert(data.end(), payload.begin(), payload.end());
+                }
+                data.resize(data.size() + ((8 - FileSize() % 8) % 8));
+                extensionsOffset = FileSize();
+                uint32_t count[2]{ (uint32_t)table.size(), 0 };
+                data.insert(data.end(), reinterpret_cast<uint8_t*>(count), reinterpret_cast<uint8_t*>(count) + sizeof(count));
+                data.insert(data.end(), reinterpret_cast<uint8_t*>(table.data()), reinterpret_cast<uint8_t*>(table.data() + table.size()));
+                if (FileSize() > INT32_MAX) {
+                    DBFLIB_THROW("file too big");
+                }
+            }
+
+            DB_FILE* header = Header();
+            header->extensions_offset = (uint32_t)extensionsOffset;
+
+            *reinterpret_cast<uint64_t*>(header->magic) = DB_FILE_MAGIC;
+            header->version = DB_FILE_CURR_VERSION;
+            header->links_table_offset = (uint32_t)linksOffset;
+            header->links_count = (uint16_t)links.size();
+            header->data_size = (uint32_t)dataSize;
+            header->file_size = (uint32_t)FileSize();
+        }
+
+        /*
+         * Sort the links by section and create the sections extension
+         */
+        void SortLinksBySection() {
+            auto sectionOf = [this](uint32_t origin) -> size_t {
+                auto it = std::upper_bound(sections.begin(), sections.end(), origin, [](uint32_t o, const DB_FILE_SECTION& s) { return o < s.begin; });
+                if (it == sections.begin() || origin >= (it - 1)->end) {
+                    return 0;
+                }
+                return (size_t)(it - sections.begin());
+            };
+            std::stable_sort(links.begin(), links.end(), [&sectionOf](const DB_FILE_LINK& a, const DB_FILE_LINK& b) {
+                return sectionOf(a.origin) < sectionOf(b.origin);
+            });
+
+            std::vector<DB_FILE_SECTION> fileSections(sections.size() + 1);
+            for (size_t i = 0; i < sections.size(); i++) {
+                fileSections[i + 1] = sections[i];
+            }
+            size_t link = 0;
+            for (size_t i = 0; i < fileSections.size(); i++) {
+                fileSections[i].first_link = (uint32_t)link;
+                while (link < links.size() && sectionOf(links[link].origin) == i) {
+                    link++;
+                }
+                fileSections[i].links_count = (uint32_t)(link - fileSections[i].first_link);
+            }
+            SetExtension(DBFE_SECTIONS, fileSections.data(), fileSections.size() * sizeof(fileSections[0]));
+        }
+
+        /*
+         * Call a function for each contiguous segment of the file, in order
+         * @param func callback (const uint8_t* buffer, size_t len)
+         */
+        template<typename Func>
+        void ForEachSegment(Func&& func) const {
+            size_t pos = 0;
+            for (const BlockView& view : views) {
+                if (view.data_offset != pos) {
+                    func(data.data() + pos, view.data_offset - pos);
+                }
+                func(view.buffer, view.len);
+                pos = view.data_offset + view.pad;
+            }
+            if (pos != data.size()) {
+                func(data.data() + pos, data.size() - pos);
+            }
+        }
+
+        /*
+         * Copy the views into the data
+         */
+        void Materialize() {
+            if (views.empty()) {
+                return;
+            }
+            std::vector<uint8_t> out{};
+            out.reserve(FileSize());
+            ForEachSegment([&out](const uint8_t* buffer, size_t len) {
+                out.insert(out.end(), buffer, buffer + len);
+            });
+            data.swap(out);
+            views.clear();
+            viewsSize = 0;
+            viewsPad = 0;
+        }
+
         inline void AssertNotLinked() {
 #ifdef DEBUG
             if (linked) {
-                throw std::runtime_error("builder already linked!");
+                DBFLIB_THROW("builder already linked!");
             }
 #endif
             linked = false;
@@ -132,41 +876,72 @@ namespace dbflib {
          * @param flags builder options, described in DB_FILE_BUILDER_OPTIONS
          */
         DBFileBuilder(uint8_t flags = 0) : flags(flags) {
-            data.resize(sizeof(DBFileBuilder));
+            data.resize(sizeof(DB_FILE));
             Header()->start_offset = (uint32_t)data.size();
         }
 
         DBFileBuilder(DBFileBuilder& o) = delete;
         DBFileBuilder(DBFileBuilder&& o) = delete;
 
-        /*
-         * Align the buffer.
-         * @param AlignType align type
-         */
-        template<typename AlignType = uint64_t>
-        void AlignBlock() {
-            data.resize((data.size() + sizeof(AlignType) - 1) & ~(sizeof(AlignType) - 1));
+        /*
+         * Align the buffer.
+         * @param AlignType align type
+         */
+        template<typename AlignType = uint64_t>
+        void AlignBlock() {
+            size_t size = FileSize();
+            data.resize(data.size() + (((size + sizeof(AlignType) - 1) & ~(sizeof(AlignType) - 1)) - size));
+        }
+
+        /*
+         * Create a block from a buffer.
+         * @param buffer buffer, should contain at least len bytes
+         * @param len length of the buffer
+         * @return block id
+         */
+        BlockId CreateBlock(const void* buffer, size_t len) {
+            AssertNotLinked();
+
+            if (flags & DB_FILE_BUILDER_OPTIONS::DBFBO_ALIGN) {
+                AlignBlock();
+            }
+
+            size_t id = FileSize();
+            if (len) {
+                if (id + len > INT32_MAX) {
+                    DBFLIB_THROW("file too big");
+                }
+                data.insert(data.end(), (const uint8_t*)buffer, (const uint8_t*)buffer + len);
+                blocks[(BlockId)id] = (BlockSize)len;
+            }
+            return (BlockId)id;
         }
 
         /*
-         * Create a block from a buffer.
+         * Create a block referencing a buffer without copying it. The buffer isn't owned by the builder, it should
+         * stay valid and unchanged until the file is written or built. WriteToFile writes it directly from the buffer,
+         * Build copies it into the file.
          * @param buffer buffer, should contain at least len bytes
          * @param len length of the buffer
          * @return block id
          */
-        BlockId CreateBlock(void* buffer, size_t len) {
+        BlockId CreateBlockView(const void* buffer, size_t len) {
             AssertNotLinked();
 
             if (flags & DB_FILE_BUILDER_OPTIONS::DBFBO_ALIGN) {
                 AlignBlock();
             }
 
-            size_t id = data.size();
+            size_t id = FileSize();
             if (len) {
                 if (id + len > INT32_MAX) {
-                    throw std::runtime_error("file too big");
+                    DBFLIB_THROW("file too big");
                 }
-                data.insert(data.end(), (uint8_t*)buffer, (uint8_t*)buffer + len);
+                size_t pad = len % DATA_ALIGNMENT;
+                views.emplace_back(id, data.size(), (const uint8_t*)buffer, len, pad);
+                data.resize(data.size() + pad);
+                viewsSize += len;
+                viewsPad += pad;
                 blocks[(BlockId)id] = (BlockSize)len;
             }
             return (BlockId)id;
@@ -186,29 +961,51 @@ namespace dbflib {
                 AlignBlock();
             }
 
-            size_t id = data.size();
+            size_t id = FileSize();
+            size_t index = data.size();
             if (len) {
                 if (id + len > INT32_MAX) {
-                    throw std::runtime_error("file too big");
+                    DBFLIB_THROW("file too big");
                 }
-                data.resize(id + len);
+                data.resize(index + len);
                 blocks[(BlockId)id] = (BlockSize)len;
             }
-            return std::make_pair((BlockId)id, reinterpret_cast<BlockType*>(&data[id]));
+            return std::make_pair((BlockId)id, reinterpret_cast<BlockType*>(data.data() + index));
         }
 
         /*
          * Get a block inside the file.
          * @param BlockType pointer type to return
          * @param id block id
-         * @return block pointer, the pointer is valid until a new block is created
+         * @return block pointer, the pointer is valid until a new block is created, for a view it is the view buffer
          */
         template<typename BlockType = void>
         BlockType* GetBlock(BlockId id) {
-            if (id > data.size()) {
-                throw std::runtime_error("invalid block");
+            if (id > FileSize()) {
+                DBFLIB_THROW("invalid block");
+            }
+            const BlockView* view = FindView(id);
+            if (!view) {
+                return reinterpret_cast<BlockType*>(data.data() + id);
             }
-            return reinterpret_cast<BlockType*>(&data[id]);
+            if (id < view->offset + view->len) {
+                return reinterpret_cast<BlockType*>(const_cast<uint8_t*>(view->buffer + (id - view->offset)));
+            }
+            return reinterpret_cast<BlockType*>(data.data() + (id - view->offset - view->len + view->data_offset + view->pad));
+        }
+
+        /*
+         * @return size of the blocks created, without the links table
+         */
+        size_t GetFileSize() const {
+            return FileSize();
+        }
+
+        /*
+         * @return count of the links created
+         */
+        size_t GetLinksCount() const {
+            return links.size();
         }
 
         /*
@@ -224,6 +1021,36 @@ namespace dbflib {
             return it->second;
         }
 
+        /*
+         * Set the type of a block, the blocks of a type are listed in the file with the DBFBO_BLOCK_TABLE option
+         * @param id block id
+         * @param type block type, 0 for an untyped block
+         */
+        void SetBlockType(BlockId id, uint32_t type) {
+            AssertNotLinked();
+            if (!blocks.contains(id)) {
+                DBFLIB_THROW("invalid block");
+            }
+            if (type) {
+                blockTypes[id] = type;
+            } else {
+                blockTypes.erase(id);
+            }
+        }
+
+        /*
+         * Set the start of the file, the first block by default
+         * @param id block id
+         * @param offset offset in the block
+         */
+        void SetStart(BlockId id, BlockOffset offset = 0) {
+            AssertNotLinked();
+            if (id < sizeof(DB_FILE) || offset > GetBlockSize(id)) {
+                DBFLIB_THROW("invalid start block");
+            }
+            Header()->start_offset = id + offset;
+        }
+
         /*
          * Create a link between 2 locations.
          * @param blockOrigin origin block id
@@ -237,100 +1064,675 @@ namespace dbflib {
             BlockSize dss = GetBlockSize(blockDestination);
 
             if (origin + 8 > ors || destination > dss) {
-                throw std::runtime_error("trying to create a link after the end of a block");
+                DBFLIB_THROW("trying to create a link after the end of a block");
             }
             
             if (links.size() >= UINT16_MAX) {
-                throw std::runtime_error("too many links");
+                DBFLIB_THROW("too many links");
             }
 
             links.emplace_back((uint32_t)(blockOrigin + origin), (uint32_t)(blockDestination + destination));
         }
 
+        /*
+         * Create a link to a host symbol, bound at loading time to the symbol registered with this name in the
+         * DBSymbolRegistry of the reader, for example a function pointer or the vtable pointer of an object.
+         * @param blockOrigin origin block id
+         * @param origin origin offset
+         * @param name symbol name
+         */
+        void CreateSymbolLink(BlockId blockOrigin, BlockOffset origin, std::string_view name) {
+            CreateSymbolLink(blockOrigin, origin, SymbolHash(name));
+        }
+
+        /*
+         * Create a link to a host symbol from its hash
+         * @param blockOrigin origin block id
+         * @param origin origin offset
+         * @param hash symbol name hash, computed with SymbolHash
+         */
+        void CreateSymbolLink(BlockId blockOrigin, BlockOffset origin, uint64_t hash) {
+            AssertNotLinked();
+            if (origin + 8 > GetBlockSize(blockOrigin)) {
+                DBFLIB_THROW("trying to create a link after the end of a block");
+            }
+            symbols.emplace_back((uint32_t)(blockOrigin + origin), 0, hash);
+        }
+
+        /*
+         * Start a section, the blocks created until EndSection are in this section. The links with an origin in a
+         * section are grouped, so a DBProgressiveLoader can link the sections separately.
+         * @param priority section priority, the sections with the higher priority are linked first
+         * @return section id, index of the section in the loader
+         */
+        size_t BeginSection(uint32_t priority = 0) {
+            AssertNotLinked();
+            if (sectionOpen) {
+                DBFLIB_THROW("section already started");
+            }
+            if (flags & DB_FILE_BUILDER_OPTIONS::DBFBO_ALIGN) {
+                AlignBlock();
+            }
+            sectionOpen = true;
+            DB_FILE_SECTION& section = sections.emplace_back();
+            section.begin = (uint32_t)FileSize();
+            section.priority = priority;
+            return sections.size();
+        }
+
+        /*
+         * End the current section
+         */
+        void EndSection() {
+            if (!sectionOpen) {
+                DBFLIB_THROW("no section started");
+            }
+            sectionOpen = false;
+            sections.back().end = (uint32_t)FileSize();
+        }
+
+        /*
+         * Set an extension of the file, replace the previous extension of the same type
+         * @param type extension type, described in DB_FILE_EXTENSION_TYPE
+         * @param buffer extension data
+         * @param len extension data length
+         */
+        void SetExtension(uint32_t type, const void* buffer, size_t len) {
+            if (len > INT32_MAX) {
+                DBFLIB_THROW("file too big");
+            }
+            std::vector<uint8_t> payload{ (const uint8_t*)buffer, (const uint8_t*)buffer + len };
+            for (auto& [t, p] : extensions) {
+                if (t == type) {
+                    p.swap(payload);
+                    return;
+                }
+            }
+            extensions.emplace_back(type, std::move(payload));
+        }
+
         /*
          * Build the file and return the start
          * @return file
          */
         DB_FILE* Build() {
-            if (linked) {
-                return Header();
+            Finalize();
+            Materialize();
+            return Header();
+        }
+
+        /*
+         * Build the file and write it into a path, the views are written from their buffers
+         * @param path path
+         * @param options write options, described in DB_FILE_WRITE_OPTIONS, ignored on non POSIX systems
+         */
+        void WriteToFile(const std::filesystem::path& path, uint32_t options = 0) {
+#ifdef DBFLIB_POSIX
+            int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                DBFLIB_THROW("can't open output file");
             }
-            linked = true;
-            size_t dataSize{ data.size() - Header()->start_offset };
-            size_t linksOffset{ data.size() };
-            if (!links.empty()) {
-                // insert links
-                size_t len = sizeof(links[0]) * links.size();
-                if (linksOffset + len > INT32_MAX) {
-                    throw std::runtime_error("file too big");
+#ifdef __cpp_exceptions
+            try {
+                WriteTo(fd, options);
+            } catch (...) {
+                close(fd);
+                throw;
+            }
+#else
+            WriteTo(fd, options);
+#endif
+            if (close(fd)) {
+                DBFLIB_THROW("can't write output file");
+            }
+#else
+            std::ofstream of{ path, std::ios::binary };
+
+            if (!of) {
+                DBFLIB_THROW("can't open output file");
+            }
+
+            WriteTo(of);
+
+            of.close();
+#endif
+        }
+
+        /*
+         * Build the file and write it into a stream
+         * @param out stream
+         */
+        void WriteTo(std::ostream& out) {
+            Finalize();
+
+            ForEachSegment([&out](const uint8_t* buffer, size_t len) {
+                out.write((const char*)buffer, len);
+            });
+
+            if (!out) {
+                DBFLIB_THROW("can't write output stream");
+            }
+        }
+
+#ifdef DBFLIB_POSIX
+        /*
+         * Build the file and write it into a file descriptor, the segments are gathered with writev
+         * @param fd file descriptor, file, pipe or socket, it isn't closed
+         * @param options write options, described in DB_FILE_WRITE_OPTIONS
+         */
+        void WriteTo(int fd, uint32_t options = 0) {
+            Finalize();
+
+            std::vector<iovec> iov{};
+            ForEachSegment([&iov](const uint8_t* buffer, size_t len) {
+                iov.emplace_back(const_cast<uint8_t*>(buffer), len);
+            });
+            size_t first = 0;
+
+#ifdef DBFLIB_LINUX
+            if ((options & DBFWO_ZERO_COPY) && SpliceTo(fd, iov, first)) {
+                return;
+            }
+#endif
+
+            if (options & DBFWO_SPARSE) {
+                struct stat st;
+                off_t base = lseek(fd, 0, SEEK_CUR);
+                if (base >= 0 && !fstat(fd, &st) && S_ISREG(st.st_mode)) {
+                    WriteSparse(fd, iov, (size_t)base, (size_t)st.st_size);
+                    return;
                 }
-                data.insert(data.end(), reinterpret_cast<uint8_t*>(links.data()), reinterpret_cast<uint8_t*>(links.data()) + len);
             }
 
-            DB_FILE* header = Header();
+            while (first < iov.size()) {
+                ssize_t w = writev(fd, &iov[first], (int)std::min<size_t>(iov.size() - first, IOV_MAX));
+                if (w < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    DBFLIB_THROW("can't write output file");
+                }
+                Consume(iov, first, (size_t)w);
+            }
+        }
+#endif
+    private:
+#ifdef DBFLIB_POSIX
+        // skip len written bytes of the segments
+        static void Consume(std::vector<iovec>& iov, size_t& first, size_t len) {
+            while (first < iov.size() && len >= iov[first].iov_len) {
+                len -= iov[first++].iov_len;
+            }
+            if (len) {
+                iov[first].iov_base = reinterpret_cast<uint8_t*>(iov[first].iov_base) + len;
+                iov[first].iov_len -= len;
+            }
+        }
 
-            *reinterpret_cast<uint64_t*>(header->magic) = DB_FILE_MAGIC;
-            header->version = DB_FILE_CURR_VERSION;
-            header->links_table_offset = (uint32_t)linksOffset;
-            header->links_count = (uint16_t)links.size();
-            header->data_size = (uint32_t)dataSize;
-            header->file_size = (uint32_t)data.size();
+        static bool IsZero(const uint8_t* buffer, size_t len) {
+            uint64_t acc = 0;
+            size_t i = 0;
+            for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+                uint64_t v;
+                std::memcpy(&v, buffer + i, sizeof(v));
+                acc |= v;
+            }
+            for (; i < len; i++) {
+                acc |= buffer[i];
+            }
+            return !acc;
+        }
 
-            return header;
+        // write the segments at an offset of fd
+        static void WriteAt(int fd, std::vector<iovec>& iov, size_t offset) {
+            if (lseek(fd, (off_t)offset, SEEK_SET) < 0) {
+                DBFLIB_THROW("can't seek output file");
+            }
+            size_t first = 0;
+            while (first < iov.size()) {
+                ssize_t w = writev(fd, &iov[first], (int)std::min<size_t>(iov.size() - first, IOV_MAX));
+                if (w < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    DBFLIB_THROW("can't write output file");
+                }
+                Consume(iov, first, (size_t)w);
+            }
+            iov.clear();
         }
 
         /*
-         * Build the file and write it into a path
+         * Write the segments into a regular file, the all zero pages aren't written. The pages before the previous end
+         * of the file are punched, or written if the file system can't punch holes.
+         * @param fd file descriptor
+         * @param iov segments
+         * @param base file offset of the segments
+         * @param fileSize previous file size
          */
-        void WriteToFile(const std::filesystem::path& path) {
-            DB_FILE* f = Build();
+        static void WriteSparse(int fd, const std::vector<iovec>& iov, size_t base, size_t fileSize) {
+            constexpr size_t page = 0x1000;
+            size_t total = 0;
+            for (const iovec& v : iov) {
+                total += v.iov_len;
+            }
 
-            std::ofstream of{ path, std::ios::binary };
+            std::vector<iovec> run{};
+            size_t runStart = 0;
+            std::vector<iovec> window{};
+            size_t seg = 0;
+            size_t segPos = 0;
+            for (size_t pos = 0; pos < total;) {
+                // pages aligned on the file offsets
+                size_t windowEnd = std::min(total, ((base + pos) / page + 1) * page - base);
+                bool zero = windowEnd - pos == page;
+                window.clear();
+                for (size_t p = pos; p < windowEnd; ) {
+                    if (segPos == iov[seg].iov_len) {
+                        seg++;
+                        segPos = 0;
+                        continue;
+                    }
+                    size_t len = std::min(iov[seg].iov_len - segPos, windowEnd - p);
+                    uint8_t* ptr = reinterpret_cast<uint8_t*>(iov[seg].iov_base) + segPos;
+                    zero = zero && IsZero(ptr, len);
+                    window.emplace_back(ptr, len);
+                    segPos += len;
+                    p += len;
+                }
 
-            if (!of) {
-                throw std::runtime_error("can't open output file");
+#ifdef DBFLIB_LINUX
+                if (zero && base + pos < fileSize) {
+                    zero = !fallocate(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE, (off_t)(base + pos), (off_t)page);
+                }
+#else
+                zero = zero && base + pos >= fileSize;
+#endif
+                if (zero) {
+                    if (!run.empty()) {
+                        WriteAt(fd, run, base + runStart);
+                    }
+                } else {
+                    if (run.empty()) {
+                        runStart = pos;
+                    }
+                    for (const iovec& v : window) {
+                        if (!run.empty() && reinterpret_cast<uint8_t*>(run.back().iov_base) + run.back().iov_len == v.iov_base) {
+                            run.back().iov_len += v.iov_len;
+                        } else {
+                            run.push_back(v);
+                        }
+                    }
+                }
+                pos = windowEnd;
+            }
+            if (!run.empty()) {
+                WriteAt(fd, run, base + runStart);
+            }
+            // a file ending with a hole
+            if (base + total > fileSize && ftruncate(fd, (off_t)(base + total))) {
+                DBFLIB_THROW("can't write output file");
+            }
+            if (lseek(fd, (off_t)(base + total), SEEK_SET) < 0) {
+                DBFLIB_THROW("can't seek output file");
+            }
+        }
+#endif
+
+#ifdef DBFLIB_LINUX
+        /*
+         * Write the segments with vmsplice, directly for a pipe or through a pipe spliced into fd
+         * @return false if splicing isn't supported, the remaining segments should be written with writev
+         */
+        static bool SpliceTo(int fd, std::vector<iovec>& iov, size_t& first) {
+            struct stat st;
+            if (fstat(fd, &st)) {
+                return false;
             }
 
-            of.write((const char*)f, f->file_size);
+            if (S_ISFIFO(st.st_mode)) {
+                while (first < iov.size()) {
+                    ssize_t w = vmsplice(fd, &iov[first], std::min<size_t>(iov.size() - first, IOV_MAX), 0);
+                    if (w < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        if (errno == EINVAL || errno == ENOSYS) {
+                            return false;
+                        }
+                        DBFLIB_THROW("can't write output pipe");
+                    }
+                    Consume(iov, first, (size_t)w);
+                }
+                return true;
+            }
 
-            of.close();
+            int pipes[2];
+            if (pipe2(pipes, O_NONBLOCK)) {
+                return false;
+            }
+            // the pipe isn't read by anyone else, fill it without blocking and drain it into fd
+            auto closePipe = [&pipes]() {
+                close(pipes[0]);
+                close(pipes[1]);
+            };
+            while (first < iov.size()) {
+                ssize_t w = vmsplice(pipes[1], &iov[first], std::min<size_t>(iov.size() - first, IOV_MAX), SPLICE_F_NONBLOCK);
+                if (w < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    closePipe();
+                    if (errno == EINVAL || errno == ENOSYS) {
+                        return false;
+                    }
+                    DBFLIB_THROW("can't write output file");
+                }
+                size_t pending = (size_t)w;
+                while (pending) {
+                    ssize_t s = splice(pipes[0], nullptr, fd, nullptr, pending, SPLICE_F_MOVE);
+                    if (s <= 0) {
+                        if (s < 0 && errno == EINTR) {
+                            continue;
+                        }
+                        if (s < 0 && errno == EINVAL && pending == (size_t)w) {
+                            // fd doesn't support splice, nothing was written
+                            closePipe();
+                            return false;
+                        }
+                        closePipe();
+                        DBFLIB_THROW("can't write output file");
+                    }
+                    pending -= (size_t)s;
+                }
+                Consume(iov, first, (size_t)w);
+            }
+            closePipe();
+            return true;
         }
+#endif
     };
 
+#ifdef DBFLIB_POSIX
+    /*
+     * Send a written file into a file descriptor, with sendfile when available
+     * @param path file path
+     * @param fd output file descriptor, it isn't closed
+     */
+    inline void SendFile(const std::filesystem::path& path, int fd) {
+        int in = open(path.c_str(), O_RDONLY);
+        if (in < 0) {
+            DBFLIB_THROW("can't open input file");
+        }
+        struct stat st;
+        if (fstat(in, &st)) {
+            close(in);
+            DBFLIB_THROW("can't read input file");
+        }
+        size_t remaining = (size_t)st.st_size;
+        bool copy = false;
+#ifdef DBFLIB_LINUX
+        while (remaining) {
+            ssize_t w = sendfile(fd, in, nullptr, remaining);
+            if (w < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                if ((errno == EINVAL || errno == ENOSYS) && remaining == (size_t)st.st_size) {
+                    copy = true;
+                    break;
+                }
+                close(in);
+                DBFLIB_THROW("can't write output file");
+            }
+            if (!w) {
+                // file truncated while sending
+                break;
+            }
+            remaining -= (size_t)w;
+        }
+#else
+        copy = true;
+#endif
+        if (copy) {
+            char buffer[0x10000];
+            ssize_t r;
+            while ((r = read(in, buffer, sizeof(buffer))) != 0) {
+                if (r < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    close(in);
+                    DBFLIB_THROW("can't read input file");
+                }
+                for (ssize_t off = 0; off < r;) {
+                    ssize_t w = write(fd, buffer + off, (size_t)(r - off));
+                    if (w < 0) {
+                        if (errno == EINTR) {
+                            continue;
+                        }
+                        close(in);
+                        DBFLIB_THROW("can't write output file");
+                    }
+                    off += w;
+                }
+            }
+        }
+        close(in);
+    }
+#endif
+
     class DBFileReader {
         std::string readData{};
         DB_FILE* file;
+        void* mapping{};
+        size_t mappingSize{};
+        bool locked{};
+        DB_FILE_READER_STATS stats{};
+
+        struct OpenTag {};
+
+        DBFileReader(OpenTag, DB_FILE* file) noexcept : file(file) {}
 
         void ValidateAndLink(size_t len = 0) {
             file->Validate(len);
             file->Link();
         }
-    public:
+
+        static std::chrono::nanoseconds Since(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        }
 
         /*
-         * Create a reader from a file
+         * Read a file, the holes of a sparse file are skipped with SEEK_DATA/SEEK_HOLE when supported
          * @param path path
+         * @param out output buffer
+         * @return file size
          */
-        DBFileReader(const std::filesystem::path& path) {
+        static size_t ReadFile(const std::filesystem::path& path, std::string& out) {
+#ifdef DBFLIB_POSIX
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                DBFLIB_THROW("can't open input file");
+            }
+            struct stat st;
+            if (fstat(fd, &st)) {
+                close(fd);
+                DBFLIB_THROW("can't read input file");
+            }
+            size_t length = (size_t)st.st_size;
+            out.resize(length);
+
+            size_t pos = 0;
+            while (pos < length) {
+                size_t end = length;
+#ifdef SEEK_DATA
+                off_t data = lseek(fd, (off_t)pos, SEEK_DATA);
+                if (data < 0 && errno == ENXIO) {
+                    // hole until the end
+                    break;
+                }
+                if (data >= 0) {
+                    pos = (size_t)data;
+                    off_t hole = lseek(fd, data, SEEK_HOLE);
+                    if (hole >= 0) {
+                        end = std::min(length, (size_t)hole);
+                    }
+                }
+#endif
+                while (pos < end) {
+                    ssize_t r = pread(fd, out.data() + pos, end - pos, (off_t)pos);
+                    if (r <= 0) {
+                        if (r < 0 && errno == EINTR) {
+                            continue;
+                        }
+                        close(fd);
+                        DBFLIB_THROW("can't read input file");
+                    }
+                    pos += (size_t)r;
+                }
+            }
+            close(fd);
+            return length;
+#else
             std::ifstream in{ path, std::ios::binary };
             if (!in) {
-                throw std::runtime_error("can't open input file");
+                DBFLIB_THROW("can't open input file");
             }
 
             in.seekg(0, std::ios::end);
             size_t length = in.tellg();
             in.seekg(0, std::ios::beg);
 
-            readData.resize(length);
+            out.resize(length);
 
-            in.read(readData.data(), length);
+            in.read(out.data(), length);
 
             in.close();
+            return length;
+#endif
+        }
+
+        void Release() {
+#ifdef DBFLIB_POSIX
+            if (locked) {
+                munlock(file, mappingSize ? mappingSize : readData.size());
+            }
+            if (mapping) {
+                munmap(mapping, mappingSize);
+            }
+#endif
+        }
+    public:
 
+        /*
+         * Create a reader from a file
+         * @param path path
+         */
+        DBFileReader(const std::filesystem::path& path) {
+            size_t length = ReadFile(path, readData);
             file = reinterpret_cast<DB_FILE*>(readData.data());
             ValidateAndLink(length);
         }
 
+        /*
+         * Create a reader from a file with load options, the mapping options are ignored on non POSIX systems
+         * @param path path
+         * @param options reader options, described in DB_FILE_READER_OPTIONS
+         * @param executor executor used to prefault and link the file
+         */
+        DBFileReader(const std::filesystem::path& path, uint32_t options, DBExecutor& executor = DefaultExecutor()) {
+            auto start = std::chrono::steady_clock::now();
+            size_t length;
+#ifdef DBFLIB_POSIX
+            if (options & DBFRO_MMAP) {
+                int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0) {
+                    DBFLIB_THROW("can't open input file");
+                }
+                struct stat st;
+                if (fstat(fd, &st)) {
+                    close(fd);
+                    DBFLIB_THROW("can't read input file");
+                }
+                length = (size_t)st.st_size;
+                if (!length) {
+                    close(fd);
+                    DBFLIB_THROW("invalid file: file too small");
+                }
+                int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+                if (options & DBFRO_POPULATE) {
+                    flags |= MAP_POPULATE;
+                }
+#endif
+                mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, fd, 0);
+                close(fd);
+                if (mapping == MAP_FAILED) {
+                    mapping = nullptr;
+                    DBFLIB_THROW("can't map input file");
+                }
+                mappingSize = length;
+                file = reinterpret_cast<DB_FILE*>(mapping);
+            } else
+#endif
+            {
+                length = ReadFile(path, readData);
+                file = reinterpret_cast<DB_FILE*>(readData.data());
+            }
+            stats.load = Since(start);
+
+#ifdef __cpp_exceptions
+            try {
+#endif
+                if (options & DBFRO_PREFAULT) {
+                    start = std::chrono::steady_clock::now();
+                    // read one byte per page, the pages written by the links are copied when linking
+                    constexpr size_t page = 0x1000;
+                    const volatile uint8_t* bytes = reinterpret_cast<const volatile uint8_t*>(file);
+                    ParallelFor(executor, (length + page - 1) / page, 256, [bytes](size_t begin, size_t end) {
+                        for (size_t i = begin; i < end; i++) {
+                            (void)bytes[i * page];
+                        }
+                    });
+                    stats.prefault = Since(start);
+                }
+
+#ifdef DBFLIB_POSIX
+                if (options & DBFRO_MLOCK) {
+                    start = std::chrono::steady_clock::now();
+                    if (mlock(file, length)) {
+                        DBFLIB_THROW("can't lock input file");
+                    }
+                    locked = true;
+                    stats.lock = Since(start);
+                }
+#endif
+
+                start = std::chrono::steady_clock::now();
+                file->Validate(length);
+                file->Link(executor);
+                stats.link = Since(start);
+#ifdef __cpp_exceptions
+            } catch (...) {
+                Release();
+                throw;
+            }
+#endif
+        }
+
+        /*
+         * Create a reader from a file and bind its symbol links
+         * @param path path
+         * @param registry host symbols
+         * @param options reader options, described in DB_FILE_READER_OPTIONS
+         * @param executor executor used to prefault and link the file
+         */
+        DBFileReader(const std::filesystem::path& path, const DBSymbolRegistry& registry, uint32_t options = 0, DBExecutor& executor = DefaultExecutor())
+            : DBFileReader(path, options, executor) {
+            file->BindSymbols(registry);
+        }
+
         /*
          * Create a reader from a buffer
          * @param buffer buffer
@@ -342,6 +1744,88 @@ namespace dbflib {
 
         DBFileReader(DBFileBuilder& o) = delete;
         DBFileReader(DBFileBuilder&& o) = delete;
+        DBFileReader(DBFileReader& o) = delete;
+
+        DBFileReader(DBFileReader&& o) noexcept
+            : readData(std::move(o.readData)), file(o.file), mapping(o.mapping), mappingSize(o.mappingSize), locked(o.locked), stats(o.stats) {
+            o.mapping = nullptr;
+            o.mappingSize = 0;
+            o.locked = false;
+        }
+
+#ifdef DBFLIB_EXPECTED
+        /*
+         * Open a buffer without throwing or allocating
+         * @param buffer buffer
+         * @param length buffer size, 0 for unknown
+         * @return reader or the file error
+         */
+        static std::expected<DBFileReader, DbfError> Open(void* buffer, size_t length = 0) noexcept {
+            DB_FILE* file = reinterpret_cast<DB_FILE*>(buffer);
+            DbfError error;
+            if (!file->Check(length, error)) {
+                return std::unexpected(error);
+            }
+            std::expected<bool, DbfError> linked = file->TryLink();
+            if (!linked) {
+                return std::unexpected(linked.error());
+            }
+            return DBFileReader{ OpenTag{}, file };
+        }
+
+#ifdef DBFLIB_POSIX
+        /*
+         * Open a file with a private mapping without throwing or allocating
+         * @param path path
+         * @return reader or the file error
+         */
+        static std::expected<DBFileReader, DbfError> Open(const std::filesystem::path& path) noexcept {
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return std::unexpected(DbfError{ DBFEC_CANT_OPEN, 0 });
+            }
+            struct stat st;
+            if (fstat(fd, &st)) {
+                close(fd);
+                return std::unexpected(DbfError{ DBFEC_CANT_READ, 0 });
+            }
+            size_t length = (size_t)st.st_size;
+            if (length < sizeof(DB_FILE)) {
+                close(fd);
+                return std::unexpected(DbfError{ DBFEC_FILE_TOO_SMALL, 0 });
+            }
+            void* mapping = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+            close(fd);
+            if (mapping == MAP_FAILED) {
+                return std::unexpected(DbfError{ DBFEC_CANT_READ, 0 });
+            }
+            DBFileReader reader{ OpenTag{}, reinterpret_cast<DB_FILE*>(mapping) };
+            reader.mapping = mapping;
+            reader.mappingSize = length;
+
+            DbfError error;
+            if (!reader.file->Check(length, error)) {
+                return std::unexpected(error);
+            }
+            std::expected<bool, DbfError> linked = reader.file->TryLink();
+            if (!linked) {
+                return std::unexpected(linked.error());
+            }
+            return reader;
+        }
+#endif
+#endif
+
+        ~DBFileReader() {
+            Release();
+        }
+
+        /*
+         * Get the time spent to load the file, only set by the constructor with options
+         */
+        constexpr const DB_FILE_READER_STATS& GetStats() const {
+            return stats;
+        }
 
         /*
          * Get file data
@@ -0,0 +1,452 @@
+#pragma once
+#include "dbflib.hpp"
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * Arrow C data interface, https://arrow.apache.org/docs/format/CDataInterface.html
+ */
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+    void (*release)(struct ArrowSchema*);
+    void* private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+    void (*release)(struct ArrowArray*);
+    void* private_data;
+};
+
+#endif // ARROW_C_DATA_INTERFACE
+
+/*
+ * Columnar tables using the Arrow memory layout
+ */
+namespace dbflib {
+    enum DB_ARROW_TYPE : uint32_t {
+        DBAT_INT8 = 1,
+        DBAT_UINT8,
+        DBAT_INT16,
+        DBAT_UINT16,
+        DBAT_INT32,
+        DBAT_UINT32,
+        DBAT_INT64,
+        DBAT_UINT64,
+        DBAT_FLOAT,
+        DBAT_DOUBLE,
+        // bit packed values
+        DBAT_BOOL,
+        // int32 offsets and utf8 values
+        DBAT_UTF8,
+    };
+
+    // alignment and padding of the buffers, relative to the file start
+    constexpr size_t DB_ARROW_ALIGNMENT = 64;
+
+    struct alignas(DB_ARROW_ALIGNMENT) DB_ARROW_ALIGN {
+        uint8_t data[DB_ARROW_ALIGNMENT];
+    };
+
+    /*
+     * Arrow column, the validity bitmap is null if the column doesn't contain null values
+     */
+    struct DB_ARROW_COLUMN {
+        uint32_t type;
+        uint32_t __pad;
+        uint64_t length;
+        uint64_t null_count;
+        uint8_t* validity;
+        int32_t* offsets;
+        void* values;
+        char* name;
+
+        /*
+         * Test if a value is valid
+         * @param id value index
+         * @return true if the value isn't null
+         */
+        bool IsValid(size_t id) const {
+            return !validity || (validity[id >> 3] >> (id & 7)) & 1;
+        }
+
+        /*
+         * Get a value of an utf8 column
+         * @param id value index
+         * @return value
+         */
+        std::string_view String(size_t id) const {
+            return { reinterpret_cast<const char*>(values) + offsets[id], (size_t)(offsets[id + 1] - offsets[id]) };
+        }
+    };
+
+    /*
+     * Arrow table, a record batch of columns with the same length
+     */
+    struct DB_ARROW_TABLE {
+        uint64_t length;
+        uint64_t column_count;
+        DB_ARROW_COLUMN* columns;
+
+        /*
+         * Find a column by name
+         * @param name column name
+         * @return column or nullptr if not found
+         */
+        DB_ARROW_COLUMN* FindColumn(std::string_view name) {
+            for (size_t i = 0; i < column_count; i++) {
+                if (name == columns[i].name) {
+                    return &columns[i];
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    /*
+     * Get the arrow type of a value type
+     * @param ValueType value type
+     * @return arrow type
+     */
+    template<typename ValueType>
+    constexpr DB_ARROW_TYPE ArrowTypeOf() {
+        if constexpr (std::is_same_v<ValueType, float>) {
+            return DBAT_FLOAT;
+        } else if constexpr (std::is_same_v<ValueType, double>) {
+            return DBAT_DOUBLE;
+        } else {
+            static_assert(std::is_integral_v<ValueType> && !std::is_same_v<ValueType, bool>, "unsupported arrow value type");
+            constexpr bool sign = std::is_signed_v<ValueType>;
+            switch (sizeof(ValueType)) {
+            case 1: return sign ? DBAT_INT8 : DBAT_UINT8;
+            case 2: return sign ? DBAT_INT16 : DBAT_UINT16;
+            case 4: return sign ? DBAT_INT32 : DBAT_UINT32;
+            default: return sign ? DBAT_INT64 : DBAT_UINT64;
+            }
+        }
+    }
+
+    /*
+     * Create a DB_ARROW_TABLE in a builder. The buffers are 64 bytes aligned and padded relative to the file start,
+     * so they are aligned in memory for a mapped file.
+     */
+    class DBArrowTableBuilder {
+        struct Column {
+            std::string name;
+            DB_ARROW_TYPE type;
+            uint64_t nullCount;
+            BlockId validity;
+            BlockId offsets;
+            BlockId values;
+        };
+
+        DBFileBuilder& builder;
+        BlockId tableId;
+        uint64_t length;
+        std::vector<Column> columns{};
+        bool built{};
+
+        // create an aligned and padded buffer, return the buffer id
+        BlockId CreateBuffer(const void* buffer, size_t len) {
+            builder.AlignBlock<DB_ARROW_ALIGN>();
+            size_t padded = std::max(DB_ARROW_ALIGNMENT, (len + DB_ARROW_ALIGNMENT - 1) & ~(DB_ARROW_ALIGNMENT - 1));
+            auto [id, ptr] = builder.CreateBlock<uint8_t>(padded);
+            if (len) {
+                std::memcpy(ptr, buffer, len);
+            }
+            return id;
+        }
+
+        // create a bitmap from bools, return the count of false values
+        BlockId CreateBitmap(const bool* values, uint64_t& falseCount) {
+            std::vector<uint8_t> bits((size_t)((length + 7) >> 3));
+            falseCount = 0;
+            for (size_t i = 0; i < length; i++) {
+                if (values[i]) {
+                    bits[i >> 3] |= (uint8_t)(1 << (i & 7));
+                } else {
+                    falseCount++;
+                }
+            }
+            return CreateBuffer(bits.data(), bits.size());
+        }
+
+        Column& AddColumn(std::string name, DB_ARROW_TYPE type, const bool* valid) {
+            if (built) {
+                DBFLIB_THROW("arrow table already built");
+            }
+            Column& column = columns.emplace_back(std::move(name), type, 0, 0, 0, 0);
+            if (valid) {
+                uint64_t nullCount{};
+                BlockId validity = CreateBitmap(valid, nullCount);
+                if (nullCount) {
+                    column.validity = validity;
+                    column.nullCount = nullCount;
+                }
+            }
+            return column;
+        }
+    public:
+        /*
+         * @param builder builder, the table block is the start of the file if the builder is empty
+         * @param length value count of the columns
+         */
+        DBArrowTableBuilder(DBFileBuilder& builder, uint64_t length) : builder(builder), length(length) {
+            auto [id, table] = builder.CreateBlock<DB_ARROW_TABLE>();
+            table->length = length;
+            tableId = id;
+        }
+
+        DBArrowTableBuilder(DBArrowTableBuilder& o) = delete;
+        DBArrowTableBuilder(DBArrowTableBuilder&& o) = delete;
+
+        /*
+         * Add a numeric column
+         * @param ValueType value type, integer, float or double
+         * @param name column name
+         * @param values values, length values
+         * @param valid validity of the values, nullptr if all the values are valid
+         */
+        template<typename ValueType>
+        void AddColumn(std::string name, const ValueType* values, const bool* valid = nullptr) {
+            Column& column = AddColumn(std::move(name), ArrowTypeOf<ValueType>(), valid);
+            column.values = CreateBuffer(values, (size_t)length * sizeof(ValueType));
+        }
+
+        /*
+         * Add a bool column, the values are bit packed
+         * @param name column name
+         * @param values values, length values
+         * @param valid validity of the values, nullptr if all the values are valid
+         */
+        void AddBoolColumn(std::string name, const bool* values, const bool* valid = nullptr) {
+            Column& column = AddColumn(std::move(name), DBAT_BOOL, valid);
+            uint64_t falseCount{};
+            column.values = CreateBitmap(values, falseCount);
+        }
+
+        /*
+         * Add an utf8 string column
+         * @param name column name
+         * @param values values, length values
+         * @param valid validity of the values, nullptr if all the values are valid
+         */
+        void AddStringColumn(std::string name, const std::string_view* values, const bool* valid = nullptr) {
+            Column& column = AddColumn(std::move(name), DBAT_UTF8, valid);
+            std::vector<int32_t> offsets((size_t)length + 1);
+            size_t size = 0;
+            for (size_t i = 0; i < length; i++) {
+                size += values[i].size();
+                if (size > INT32_MAX) {
+                    DBFLIB_THROW("arrow string column too big");
+                }
+                offsets[i + 1] = (int32_t)size;
+            }
+            column.offsets = CreateBuffer(offsets.data(), offsets.size() * sizeof(int32_t));
+
+            builder.AlignBlock<DB_ARROW_ALIGN>();
+            size_t padded = std::max(DB_ARROW_ALIGNMENT, (size + DB_ARROW_ALIGNMENT - 1) & ~(DB_ARROW_ALIGNMENT - 1));
+            auto [id, ptr] = builder.CreateBlock<char>(padded);
+            for (size_t i = 0; i < length; i++) {
+                std::memcpy(ptr + offsets[i], values[i].data(), values[i].size());
+            }
+            column.values = id;
+        }
+
+        /*
+         * Create the columns block and link the table
+         * @return table block id
+         */
+        BlockId Build() {
+            if (built) {
+                return tableId;
+            }
+            built = true;
+            builder.GetBlock<DB_ARROW_TABLE>(tableId)->column_count = columns.size();
+            if (columns.empty()) {
+                return tableId;
+            }
+
+            auto [columnsId, block] = builder.CreateBlock<DB_ARROW_COLUMN>(columns.size() * sizeof(DB_ARROW_COLUMN));
+            for (size_t i = 0; i < columns.size(); i++) {
+                block[i].type = columns[i].type;
+                block[i].length = length;
+                block[i].null_count = columns[i].nullCount;
+            }
+            builder.CreateLink(tableId, offsetof(DB_ARROW_TABLE, columns), columnsId);
+            for (size_t i = 0; i < columns.size(); i++) {
+                const Column& column = columns[i];
+                BlockOffset offset = (BlockOffset)(i * sizeof(DB_ARROW_COLUMN));
+                if (column.validity) {
+                    builder.CreateLink(columnsId, offset + offsetof(DB_ARROW_COLUMN, validity), column.validity);
+                }
+                if (column.offsets) {
+                    builder.CreateLink(columnsId, offset + offsetof(DB_ARROW_COLUMN, offsets), column.offsets);
+                }
+                builder.CreateLink(columnsId, offset + offsetof(DB_ARROW_COLUMN, values), column.values);
+                BlockId nameId = builder.CreateBlock(column.name.c_str(), column.name.size() + 1);
+                builder.CreateLink(columnsId, offset + offsetof(DB_ARROW_COLUMN, name), nameId);
+            }
+            return tableId;
+        }
+    };
+
+    /*
+     * Export the linked arrow tables through the Arrow C data interface. The exported buffers are pointing into the
+     * file, the owner is kept alive until the consumer releases all the exported structures.
+     */
+    class DBArrowExporter {
+        struct ArrayData {
+            std::shared_ptr<void> owner;
+            const void* buffers[3]{};
+            std::unique_ptr<ArrowArray[]> children{};
+            std::unique_ptr<ArrowArray*[]> childrenPtr{};
+        };
+
+        struct SchemaData {
+            std::shared_ptr<void> owner;
+            std::unique_ptr<ArrowSchema[]> children{};
+            std::unique_ptr<ArrowSchema*[]> childrenPtr{};
+        };
+
+        static void ReleaseArray(ArrowArray* array) {
+            // the moved children are already released
+            for (int64_t i = 0; i < array->n_children; i++) {
+                if (array->children[i]->release) {
+                    array->children[i]->release(array->children[i]);
+                }
+            }
+            delete reinterpret_cast<ArrayData*>(array->private_data);
+            array->release = nullptr;
+        }
+
+        static void ReleaseSchema(ArrowSchema* schema) {
+            for (int64_t i = 0; i < schema->n_children; i++) {
+                if (schema->children[i]->release) {
+                    schema->children[i]->release(schema->children[i]);
+                }
+            }
+            delete reinterpret_cast<SchemaData*>(schema->private_data);
+            schema->release = nullptr;
+        }
+
+        static const char* Format(uint32_t type) {
+            switch (type) {
+            case DBAT_INT8: return "c";
+            case DBAT_UINT8: return "C";
+            case DBAT_INT16: return "s";
+            case DBAT_UINT16: return "S";
+            case DBAT_INT32: return "i";
+            case DBAT_UINT32: return "I";
+            case DBAT_INT64: return "l";
+            case DBAT_UINT64: return "L";
+            case DBAT_FLOAT: return "f";
+            case DBAT_DOUBLE: return "g";
+            case DBAT_BOOL: return "b";
+            case DBAT_UTF8: return "u";
+            default: return nullptr;
+            }
+        }
+
+        static void CheckColumn(const DB_ARROW_COLUMN& column) {
+            if (!Format(column.type)) {
+                DBFLIB_THROW("invalid arrow column: bad type");
+            }
+            if (!column.values || (column.type == DBAT_UTF8 && !column.offsets)) {
+                DBFLIB_THROW("invalid arrow column: missing buffer");
+            }
+            if (column.null_count && !column.validity) {
+                DBFLIB_THROW("invalid arrow column: null values without validity");
+            }
+        }
+
+        static void FillColumn(DB_ARROW_COLUMN& column, ArrowArray* array, ArrowSchema* schema, const std::shared_ptr<void>& owner) {
+            bool utf8 = column.type == DBAT_UTF8;
+            ArrayData* arrayData = new ArrayData{ owner };
+            arrayData->buffers[0] = column.validity;
+            arrayData->buffers[1] = utf8 ? (const void*)column.offsets : column.values;
+            arrayData->buffers[2] = column.values;
+            *array = ArrowArray{
+                (int64_t)column.length, (int64_t)column.null_count, 0, utf8 ? 3 : 2, 0,
+                arrayData->buffers, nullptr, nullptr, &ReleaseArray, arrayData
+            };
+            *schema = ArrowSchema{
+                Format(column.type), column.name, nullptr, ARROW_FLAG_NULLABLE, 0,
+                nullptr, nullptr, &ReleaseSchema, new SchemaData{ owner }
+            };
+        }
+    public:
+        /*
+         * Export a column
+         * @param column linked column
+         * @param array exported array
+         * @param schema exported schema
+         * @param owner owner of the file memory, kept alive by the exported structures
+         */
+        static void ExportColumn(DB_ARROW_COLUMN& column, ArrowArray* array, ArrowSchema* schema, std::shared_ptr<void> owner = {}) {
+            CheckColumn(column);
+            FillColumn(column, array, schema, owner);
+        }
+
+        /*
+         * Export a table as a struct array, the columns are the children
+         * @param table linked table
+         * @param array exported array
+         * @param schema exported schema
+         * @param owner owner of the file memory, kept alive by the exported structures
+         */
+        static void ExportTable(DB_ARROW_TABLE& table, ArrowArray* array, ArrowSchema* schema, std::shared_ptr<void> owner = {}) {
+            size_t count = (size_t)table.column_count;
+            for (size_t i = 0; i < count; i++) {
+                CheckColumn(table.columns[i]);
+                if (table.columns[i].length != table.length) {
+                    DBFLIB_THROW("invalid arrow table: bad column length");
+                }
+            }
+            std::unique_ptr<ArrayData> arrayData = std::make_unique<ArrayData>(owner);
+            std::unique_ptr<SchemaData> schemaData = std::make_unique<SchemaData>(owner);
+            arrayData->children = std::make_unique<ArrowArray[]>(count);
+            arrayData->childrenPtr = std::make_unique<ArrowArray*[]>(count);
+            schemaData->children = std::make_unique<ArrowSchema[]>(count);
+            schemaData->childrenPtr = std::make_unique<ArrowSchema*[]>(count);
+            for (size_t i = 0; i < count; i++) {
+                FillColumn(table.columns[i], &arrayData->children[i], &schemaData->children[i], owner);
+                arrayData->childrenPtr[i] = &arrayData->children[i];
+                schemaData->childrenPtr[i] = &schemaData->children[i];
+            }
+            *array = ArrowArray{
+                (int64_t)table.length, 0, 0, 1, (int64_t)count,
+                arrayData->buffers, arrayData->childrenPtr.get(), nullptr, &ReleaseArray, arrayData.get()
+            };
+            *schema = ArrowSchema{
+                "+s", "", nullptr, 0, (int64_t)count,
+                schemaData->childrenPtr.get(), nullptr, &ReleaseSchema, schemaData.get()
+            };
+            arrayData.release();
+            schemaData.release();
+        }
+    };
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * Split block Bloom filter blocks
+ */
+namespace dbflib {
+    /*
+     * Filter block, one bit is set in each word for each key, a block is 32 bytes so a probe reads a single cache line
+     */
+    struct DB_BLOOM_FILTER_BLOCK {
+        uint32_t words[8];
+    };
+
+    // multiplicative salts selecting the bit of each word
+    constexpr uint32_t DB_BLOOM_FILTER_SALTS[8]{
+        0x47b6137bu, 0x44974d91u, 0x8824ad5bu, 0xa2b7289du,
+        0x705495c7u, 0x2df1424bu, 0x9efc4947u, 0x5c6bfb31u,
+    };
+
+    /*
+     * Approximate membership filter, no false negatives
+     */
+    struct DB_BLOOM_FILTER {
+        uint64_t block_count{};
+        uint64_t seed{};
+        DB_BLOOM_FILTER_BLOCK* blocks{};
+
+        /*
+         * Hash a key for this filter
+         * @param key key, string or integer
+         * @return hash
+         */
+        template<typename KeyType>
+        uint64_t Hash(const KeyType& key) const {
+            if constexpr (std::is_integral_v<KeyType>) {
+                return utils::Mix64((uint64_t)key ^ utils::Mix64(seed));
+            } else {
+                return utils::Hash64(std::string_view{ key }, seed);
+            }
+        }
+
+        /*
+         * Test if a hash might be in the filter
+         * @param hash hash, computed with Hash
+         * @return false if the hash isn't in the filter, true if it might be
+         */
+        bool MayContainHash(uint64_t hash) const {
+            const DB_BLOOM_FILTER_BLOCK& block = blocks[((hash >> 32) * block_count) >> 32];
+            uint32_t key = (uint32_t)hash;
+#ifdef DBFLIB_AVX2
+            __m256i salts = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(DB_BLOOM_FILTER_SALTS));
+            __m256i bits = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_set1_epi32((int)key), salts), 27);
+            __m256i mask = _mm256_sllv_epi32(_mm256_set1_epi32(1), bits);
+            __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block.words));
+            return _mm256_testc_si256(words, mask);
+#else
+            for (size_t i = 0; i < 8; i++) {
+                if (!(block.words[i] & (1u << ((key * DB_BLOOM_FILTER_SALTS[i]) >> 27)))) {
+                    return false;
+                }
+            }
+            return true;
+#endif
+        }
+
+        /*
+         * Test if a key might be in the filter
+         * @param key key, string or integer
+         * @return false if the key isn't in the filter, true if it might be
+         */
+        template<typename KeyType>
+        bool MayContain(const KeyType& key) const {
+            return MayContainHash(Hash(key));
+        }
+    };
+
+    /*
+     * Create a Bloom filter.
+     * @param builder builder
+     * @param keys keys, the elements should be integers or convertible to std::string_view
+     * @param bitsPerKey filter bits per key, 10 bits are giving around 1% of false positives
+     * @param seed hash seed
+     * @return block id of the DB_BLOOM_FILTER
+     */
+    template<typename Keys>
+    BlockId CreateBloomFilter(DBFileBuilder& builder, const Keys& keys, size_t bitsPerKey = 10, uint64_t seed = 0) {
+        size_t count = std::size(keys);
+        size_t blockCount = std::max<size_t>(1, (count * bitsPerKey + 255) / 256);
+        if (blockCount * sizeof(DB_BLOOM_FILTER_BLOCK) > INT32_MAX || blockCount > UINT32_MAX) {
+            DBFLIB_THROW("file too big");
+        }
+
+        builder.AlignBlock();
+        auto [filterId, filter] = builder.CreateBlock<DB_BLOOM_FILTER>();
+        filter->block_count = blockCount;
+        filter->seed = seed;
+        DB_BLOOM_FILTER hasher = *filter;
+
+        builder.AlignBlock<DB_BLOOM_FILTER_BLOCK>();
+        auto [blocksId, blocks] = builder.CreateBlock<DB_BLOOM_FILTER_BLOCK>(blockCount * sizeof(DB_BLOOM_FILTER_BLOCK));
+        for (const auto& key : keys) {
+            uint64_t hash = hasher.Hash(key);
+            DB_BLOOM_FILTER_BLOCK& block = blocks[((hash >> 32) * blockCount) >> 32];
+            for (size_t i = 0; i < 8; i++) {
+                block.words[i] |= 1u << (((uint32_t)hash * DB_BLOOM_FILTER_SALTS[i]) >> 27);
+            }
+        }
+        builder.CreateLink(filterId, offsetof(DB_BLOOM_FILTER, blocks), blocksId);
+
+        return filterId;
+    }
+}
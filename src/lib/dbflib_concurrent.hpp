@@ -0,0 +1,254 @@
+#pragma once
+#include "dbflib.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+
+/*
+ * Concurrent file builder
+ */
+namespace dbflib {
+    /*
+     * File builder shared by multiple threads. The blocks are allocated in a preallocated zeroed region with an atomic
+     * bump pointer and the links are stored by producer, so the threads aren't synchronized while creating the blocks.
+     * The block sizes aren't stored, the links are only checked against the region.
+     */
+    class DBConcurrentFileBuilder {
+        struct RegionDeleter {
+            void operator()(uint8_t* ptr) const {
+                std::free(ptr);
+            }
+        };
+
+        uint8_t flags{};
+        size_t capacity;
+        std::unique_ptr<uint8_t[], RegionDeleter> region{};
+        std::atomic<size_t> next{};
+        std::atomic<bool> linked{};
+        std::mutex producersMutex{};
+        std::vector<std::unique_ptr<std::vector<DB_FILE_LINK>>> producersLinks{};
+
+        DB_FILE* Header() {
+            return reinterpret_cast<DB_FILE*>(region.get());
+        }
+
+        void AssertNotLinked() const {
+            if (linked.load(std::memory_order_relaxed)) {
+                DBFLIB_THROW("file already linked");
+            }
+        }
+
+        // allocate len bytes, return the offset of the block
+        size_t Allocate(size_t len) {
+            AssertNotLinked();
+            if (flags & DB_FILE_BUILDER_OPTIONS::DBFBO_ALIGN) {
+                len = (len + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+            }
+            // only commit the blocks fitting in the region, a rejected block doesn't consume it
+            size_t id = next.load(std::memory_order_relaxed);
+            do {
+                if (len > capacity - id) {
+                    DBFLIB_THROW("concurrent builder region full");
+                }
+            } while (!next.compare_exchange_weak(id, id + len, std::memory_order_relaxed));
+            return id;
+        }
+    public:
+        /*
+         * Producer handle, the links are stored without synchronization, a producer should only be used by one thread at a time
+         */
+        class Producer {
+            friend class DBConcurrentFileBuilder;
+            DBConcurrentFileBuilder* builder;
+            std::vector<DB_FILE_LINK>* links;
+
+            Producer(DBConcurrentFileBuilder* builder, std::vector<DB_FILE_LINK>* links) : builder(builder), links(links) {}
+        public:
+            /*
+             * Create a block inside the file using a buffer.
+             * @param buffer buffer
+             * @param len length of the buffer
+             * @return block id
+             */
+            BlockId CreateBlock(const void* buffer, size_t len) {
+                return builder->CreateBlock(buffer, len);
+            }
+
+            /*
+             * Create a block inside the file.
+             * @param BlockType pointer type to return
+             * @param len length of the block
+             * @return block id and pointer, the pointer is valid until the file is built
+             */
+            template<typename BlockType = void>
+            std::pair<BlockId, BlockType*> CreateBlock(const size_t len = sizeof(BlockType)) {
+                return builder->CreateBlock<BlockType>(len);
+            }
+
+            /*
+             * Create a link between 2 blocks
+             * @param blockOrigin origin block
+             * @param origin origin offset in the origin block
+             * @param blockDestination destination block
+             * @param destination destination offset in the destination block
+             */
+            void CreateLink(BlockId blockOrigin, BlockOffset origin, BlockId blockDestination, BlockOffset destination = 0) {
+                builder->AssertNotLinked();
+                size_t o = (size_t)blockOrigin + origin;
+                size_t d = (size_t)blockDestination + destination;
+                if (o < sizeof(DB_FILE) || o + 8 > builder->capacity || d > builder->capacity) {
+                    DBFLIB_THROW("trying to create a link outside of the region");
+                }
+                links->emplace_back((uint32_t)o, (uint32_t)d);
+            }
+        };
+
+        /*
+         * @param capacity max file size, the region is zeroed lazily by the system allocator
+         * @param flags builder options, described in DB_FILE_BUILDER_OPTIONS
+         */
+        DBConcurrentFileBuilder(size_t capacity, uint8_t flags = 0) : flags(flags), capacity(capacity) {
+            if (capacity > INT32_MAX) {
+                DBFLIB_THROW("file too big");
+            }
+            if (capacity < sizeof(DB_FILE)) {
+                DBFLIB_THROW("concurrent builder region too small");
+            }
+            region.reset(static_cast<uint8_t*>(std::calloc(capacity, 1)));
+            if (!region) {
+                DBFLIB_THROW("can't allocate the concurrent builder region");
+            }
+            next.store(sizeof(DB_FILE), std::memory_order_relaxed);
+            Header()->start_offset = (uint32_t)sizeof(DB_FILE);
+        }
+
+        DBConcurrentFileBuilder(DBConcurrentFileBuilder& o) = delete;
+        DBConcurrentFileBuilder(DBConcurrentFileBuilder&& o) = delete;
+
+        /*
+         * Create a producer, the handle is valid until the builder is destroyed
+         * @return producer
+         */
+        Producer CreateProducer() {
+            std::lock_guard lock{ producersMutex };
+            std::vector<DB_FILE_LINK>* links = producersLinks.emplace_back(std::make_unique<std::vector<DB_FILE_LINK>>()).get();
+            return Producer{ this, links };
+        }
+
+        /*
+         * Create a block inside the file using a buffer, can be called concurrently.
+         * @param buffer buffer
+         * @param len length of the buffer
+         * @return block id
+         */
+        BlockId CreateBlock(const void* buffer, size_t len) {
+            size_t id = Allocate(len);
+            std::memcpy(region.get() + id, buffer, len);
+            return (BlockId)id;
+        }
+
+        /*
+         * Create a zeroed block inside the file, can be called concurrently.
+         * @param BlockType pointer type to return
+         * @param len length of the block
+         * @return block id and pointer, the pointer is valid until the file is built
+         */
+        template<typename BlockType = void>
+        std::pair<BlockId, BlockType*> CreateBlock(const size_t len = sizeof(BlockType)) {
+            size_t id = Allocate(len);
+            return std::make_pair((BlockId)id, reinterpret_cast<BlockType*>(region.get() + id));
+        }
+
+        /*
+         * Get a block from its id
+         * @param BlockType pointer type to return
+         * @param id block id
+         * @return block pointer, the pointer is valid until the file is built
+         */
+        template<typename BlockType = void>
+        BlockType* GetBlock(BlockId id) {
+            if (id >= capacity) {
+                DBFLIB_THROW("invalid block");
+            }
+            return reinterpret_cast<BlockType*>(region.get() + id);
+        }
+
+        /*
+         * Set the start block of the file
+         * @param id block id
+         */
+        void SetStart(BlockId id) {
+            AssertNotLinked();
+            if (id < sizeof(DB_FILE) || id > capacity) {
+                DBFLIB_THROW("invalid block");
+            }
+            Header()->start_offset = id;
+        }
+
+        /*
+         * Merge the producers links and build the file, the producers should have stopped
+         * @return file
+         */
+        DB_FILE* Build() {
+            if (linked.load(std::memory_order_acquire)) {
+                return Header();
+            }
+            size_t dataEnd = next.load(std::memory_order_acquire);
+            size_t linksOffset = (dataEnd + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1);
+
+            size_t linksCount = 0;
+            for (const auto& links : producersLinks) {
+                linksCount += links->size();
+            }
+            if (linksCount > UINT16_MAX) {
+                DBFLIB_THROW("too many links");
+            }
+            size_t fileSize = linksOffset + linksCount * sizeof(DB_FILE_LINK);
+            if (fileSize > capacity) {
+                DBFLIB_THROW("concurrent builder region full");
+            }
+            for (const auto& links : producersLinks) {
+                for (const DB_FILE_LINK& link : *links) {
+                    if (link.origin + 8 > dataEnd || link.destination > dataEnd) {
+                        DBFLIB_THROW("trying to create a link after the end of the file");
+                    }
+                }
+            }
+            // the checks passed, a failed build can be retried
+            linked.store(true, std::memory_order_release);
+
+            DB_FILE_LINK* table = reinterpret_cast<DB_FILE_LINK*>(region.get() + linksOffset);
+            for (const auto& links : producersLinks) {
+                table = std::copy(links->begin(), links->end(), table);
+            }
+
+            DB_FILE* header = Header();
+            *reinterpret_cast<uint64_t*>(header->magic) = DB_FILE_MAGIC;
+            header->version = DB_FILE_CURR_VERSION;
+            header->links_table_offset = (uint32_t)linksOffset;
+            header->links_count = (uint16_t)linksCount;
+            header->data_size = (uint32_t)(linksOffset - header->start_offset);
+            header->file_size = (uint32_t)fileSize;
+            return header;
+        }
+
+        /*
+         * Build the file and write it into a path
+         * @param path path
+         */
+        void WriteToFile(const std::filesystem::path& path) {
+            DB_FILE* file = Build();
+            std::ofstream of{ path, std::ios::binary };
+
+            if (!of) {
+                DBFLIB_THROW("can't open output file");
+            }
+
+            of.write(reinterpret_cast<const char*>(file), file->file_size);
+
+            of.close();
+        }
+    };
+}
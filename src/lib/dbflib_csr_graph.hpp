@@ -0,0 +1,205 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <span>
+
+/*
+ * Compressed sparse row graph blocks
+ */
+namespace dbflib {
+    enum DB_CSR_GRAPH_FLAGS : uint32_t {
+        // neighbors are stored as varint(degree) + varint deltas
+        DBCSR_COMPRESSED = 1,
+    };
+
+    // distance of the nodes not reached by a traversal
+    constexpr uint32_t DB_CSR_GRAPH_UNREACHED = UINT32_MAX;
+
+    /*
+     * Directed graph, the neighbors of the node n are described in neighbors from offsets[n] to offsets[n + 1].
+     * For a compressed graph, the offsets are byte offsets of the node's varint sequence.
+     */
+    struct DB_CSR_GRAPH {
+        uint32_t node_count{};
+        uint32_t flags{};
+        uint64_t edge_count{};
+        uint32_t* offsets{};
+        uint8_t* neighbors{};
+
+        /*
+         * @return true if the neighbors are compressed
+         */
+        constexpr bool IsCompressed() const {
+            return flags & DBCSR_COMPRESSED;
+        }
+
+        /*
+         * Get the out degree of a node
+         * @param node node
+         * @return degree
+         */
+        uint32_t Degree(uint32_t node) const {
+            if (IsCompressed()) {
+                const uint8_t* ptr = neighbors + offsets[node];
+                return (uint32_t)utils::ReadVarInt(ptr);
+            }
+            return offsets[node + 1] - offsets[node];
+        }
+
+        /*
+         * Get the neighbors of a node, only for the uncompressed graphs
+         * @param node node
+         * @return sorted neighbors
+         */
+        std::span<const uint32_t> Neighbors(uint32_t node) const {
+            if (IsCompressed()) {
+                DBFLIB_THROW("can't get a span of a compressed graph");
+            }
+            return std::span<const uint32_t>{ reinterpret_cast<const uint32_t*>(neighbors) + offsets[node], offsets[node + 1] - offsets[node] };
+        }
+
+        /*
+         * Iterate over the neighbors of a node in ascending order
+         * @param node node
+         * @param func callback (uint32_t neighbor)
+         */
+        template<typename Func>
+        void ForEachNeighbor(uint32_t node, Func&& func) const {
+            if (IsCompressed()) {
+                const uint8_t* ptr = neighbors + offsets[node];
+                uint64_t degree = utils::ReadVarInt(ptr);
+                uint32_t neighbor = 0;
+                for (uint64_t i = 0; i < degree; i++) {
+                    neighbor += (uint32_t)utils::ReadVarInt(ptr);
+                    func(neighbor);
+                }
+            } else {
+                for (uint32_t neighbor : Neighbors(node)) {
+                    func(neighbor);
+                }
+            }
+        }
+
+        /*
+         * Breadth first traversal, the frontiers are split between the executor threads
+         * @param source source node
+         * @param executor executor
+         * @param grain min frontier nodes per task, a smaller frontier is explored by the calling thread
+         * @return distance of each node from the source, DB_CSR_GRAPH_UNREACHED for the unreached nodes
+         */
+        std::vector<uint32_t> BreadthFirstSearch(uint32_t source, DBExecutor& executor = DefaultExecutor(), size_t grain = 1024) const {
+            std::vector<std::atomic<uint32_t>> distances(node_count);
+            for (std::atomic<uint32_t>& d : distances) {
+                d.store(DB_CSR_GRAPH_UNREACHED, std::memory_order_relaxed);
+            }
+            std::vector<uint32_t> frontier{};
+            if (source < node_count) {
+                distances[source].store(0, std::memory_order_relaxed);
+                frontier.push_back(source);
+            }
+
+            std::mutex nextMutex{};
+            for (uint32_t level = 1; !frontier.empty(); level++) {
+                std::vector<uint32_t> next{};
+                ParallelFor(executor, frontier.size(), grain, [&](size_t begin, size_t end) {
+                    std::vector<uint32_t> local{};
+                    for (size_t i = begin; i < end; i++) {
+                        ForEachNeighbor(frontier[i], [&](uint32_t neighbor) {
+                            uint32_t expected = DB_CSR_GRAPH_UNREACHED;
+                            if (distances[neighbor].load(std::memory_order_relaxed) == DB_CSR_GRAPH_UNREACHED
+                                && distances[neighbor].compare_exchange_strong(expected, level, std::memory_order_relaxed)) {
+                                local.push_back(neighbor);
+                            }
+                        });
+                    }
+                    std::lock_guard lock{ nextMutex };
+                    next.insert(next.end(), local.begin(), local.end());
+                });
+                frontier.swap(next);
+            }
+
+            std::vector<uint32_t> result(node_count);
+            for (size_t i = 0; i < node_count; i++) {
+                result[i] = distances[i].load(std::memory_order_relaxed);
+            }
+            return result;
+        }
+    };
+
+    /*
+     * Create a compressed sparse row graph from an edge list.
+     * @param builder builder
+     * @param nodeCount node count
+     * @param edges directed edges (origin, destination)
+     * @param compress store the neighbors as varint deltas
+     * @return block id of the DB_CSR_GRAPH
+     */
+    inline BlockId CreateCsrGraph(DBFileBuilder& builder, uint32_t nodeCount, std::span<const std::pair<uint32_t, uint32_t>> edges, bool compress = false) {
+        if (edges.size() > INT32_MAX / sizeof(uint32_t)) {
+            DBFLIB_THROW("file too big");
+        }
+        // counting sort by origin
+        std::vector<uint32_t> offsets(nodeCount + 1ull);
+        for (const auto& [origin, destination] : edges) {
+            if (origin >= nodeCount || destination >= nodeCount) {
+                DBFLIB_THROW("graph edge with an invalid node");
+            }
+            offsets[origin + 1]++;
+        }
+        for (size_t i = 0; i < nodeCount; i++) {
+            offsets[i + 1] += offsets[i];
+        }
+        std::vector<uint32_t> neighbors(edges.size());
+        {
+            std::vector<uint32_t> cursors{ offsets.begin(), offsets.end() - 1 };
+            for (const auto& [origin, destination] : edges) {
+                neighbors[cursors[origin]++] = destination;
+            }
+        }
+        for (size_t i = 0; i < nodeCount; i++) {
+            std::sort(neighbors.begin() + offsets[i], neighbors.begin() + offsets[i + 1]);
+        }
+
+        std::vector<uint8_t> data{};
+        if (compress) {
+            std::vector<uint32_t> byteOffsets(nodeCount + 1ull);
+            for (size_t i = 0; i < nodeCount; i++) {
+                byteOffsets[i] = (uint32_t)data.size();
+                utils::WriteVarInt(data, offsets[i + 1] - offsets[i]);
+                uint32_t prev = 0;
+                for (size_t j = offsets[i]; j < offsets[i + 1]; j++) {
+                    utils::WriteVarInt(data, neighbors[j] - prev);
+                    prev = neighbors[j];
+                }
+                if (data.size() > INT32_MAX) {
+                    DBFLIB_THROW("file too big");
+                }
+            }
+            byteOffsets[nodeCount] = (uint32_t)data.size();
+            offsets.swap(byteOffsets);
+        } else {
+            data.resize(neighbors.size() * sizeof(uint32_t));
+            std::memcpy(data.data(), neighbors.data(), data.size());
+        }
+        // keep a valid pointer for the graphs without edges
+        data.resize(data.size() + sizeof(uint32_t));
+
+        builder.AlignBlock();
+        auto [graphId, graph] = builder.CreateBlock<DB_CSR_GRAPH>();
+        graph->node_count = nodeCount;
+        graph->flags = compress ? (uint32_t)DBCSR_COMPRESSED : 0;
+        graph->edge_count = edges.size();
+
+        builder.AlignBlock();
+        BlockId offsetsId = builder.CreateBlock(offsets.data(), offsets.size() * sizeof(offsets[0]));
+        builder.AlignBlock();
+        BlockId neighborsId = builder.CreateBlock(data.data(), data.size());
+        builder.CreateLink(graphId, offsetof(DB_CSR_GRAPH, offsets), offsetsId);
+        builder.CreateLink(graphId, offsetof(DB_CSR_GRAPH, neighbors), neighborsId);
+
+        return graphId;
+    }
+}
@@ -0,0 +1,273 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+
+/*
+ * Dictionary encoded string column blocks
+ */
+namespace dbflib {
+    /*
+     * String column stored as a sorted dictionary of the distinct values and one code per row, the codes
+     * are using code_width bytes (1, 2 or 4). The dictionary is sorted, so a range of strings is a range of codes.
+     */
+    struct DB_DICTIONARY_COLUMN {
+        static constexpr uint32_t npos = UINT32_MAX;
+
+        uint64_t row_count{};
+        uint32_t dictionary_size{};
+        uint32_t code_width{};
+        uint32_t* offsets{};
+        char* strings{};
+        uint8_t* codes{};
+
+        /*
+         * Get a dictionary value
+         * @param code code
+         * @return value
+         */
+        std::string_view Value(uint32_t code) const {
+            return std::string_view{ strings + offsets[code], offsets[code + 1] - offsets[code] };
+        }
+
+        /*
+         * Get the code of a row
+         * @param row row
+         * @return code
+         */
+        uint32_t Code(size_t row) const {
+            switch (code_width) {
+            case 1: return codes[row];
+            case 2: return reinterpret_cast<const uint16_t*>(codes)[row];
+            default: return reinterpret_cast<const uint32_t*>(codes)[row];
+            }
+        }
+
+        /*
+         * Get the value of a row
+         * @param row row
+         * @return value
+         */
+        std::string_view operator[](size_t row) const {
+            return Value(Code(row));
+        }
+
+        /*
+         * Find the code of a value
+         * @param value value
+         * @return code, npos if the value isn't in the dictionary
+         */
+        uint32_t Find(std::string_view value) const {
+            uint32_t code = LowerBound(value);
+            if (code == dictionary_size || Value(code) != value) {
+                return npos;
+            }
+            return code;
+        }
+
+        /*
+         * Find the codes of the values starting with a prefix
+         * @param prefix prefix
+         * @return code range [first, second)
+         */
+        std::pair<uint32_t, uint32_t> FindPrefix(std::string_view prefix) const {
+            uint32_t lo = LowerBound(prefix);
+            uint32_t hi = lo;
+            while (hi < dictionary_size && Value(hi).starts_with(prefix)) {
+                hi++;
+            }
+            return std::make_pair(lo, hi);
+        }
+
+        /*
+         * Find the rows with a code in a range
+         * @param first first code
+         * @param end end code, exclusive
+         * @param bitmap output bitmap, at least (row_count + 63) / 64 words, bit i is set if the row i matches
+         * @return matching row count
+         */
+        size_t Filter(uint32_t first, uint32_t end, uint64_t* bitmap) const {
+            switch (code_width) {
+            case 1: return FilterCodes<uint8_t>(first, end, bitmap);
+            case 2: return FilterCodes<uint16_t>(first, end, bitmap);
+            default: return FilterCodes<uint32_t>(first, end, bitmap);
+            }
+        }
+
+        /*
+         * Find the rows with a value
+         * @param value value
+         * @return bitmap of the matching rows, bit i is set if the row i matches
+         */
+        std::vector<uint64_t> FilterEquals(std::string_view value) const {
+            std::vector<uint64_t> bitmap((row_count + 63) / 64);
+            uint32_t code = Find(value);
+            if (code != npos) {
+                Filter(code, code + 1, bitmap.data());
+            }
+            return bitmap;
+        }
+
+    private:
+        uint32_t LowerBound(std::string_view value) const {
+            uint32_t lo = 0;
+            uint32_t hi = dictionary_size;
+            while (lo < hi) {
+                uint32_t mid = (lo + hi) / 2;
+                if (Value(mid) < value) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            return lo;
+        }
+
+        template<typename CodeType>
+        size_t FilterCodes(uint32_t first, uint32_t end, uint64_t* bitmap) const {
+            const CodeType* c = reinterpret_cast<const CodeType*>(codes);
+            size_t words = (size_t)((row_count + 63) / 64);
+            if (end <= first) {
+                std::fill(bitmap, bitmap + words, 0);
+                return 0;
+            }
+            // code in [first, end) <=> (code - first) < (end - first) as unsigned
+            uint64_t span = (uint64_t)end - first;
+            if (span > std::numeric_limits<CodeType>::max()) {
+                span = (uint64_t)std::numeric_limits<CodeType>::max() + 1;
+            }
+            CodeType base = (CodeType)first;
+            size_t matches = 0;
+            size_t row = 0;
+            for (size_t w = 0; w < words; w++) {
+                uint64_t word = 0;
+                size_t rows = std::min<size_t>(64, (size_t)row_count - row);
+                size_t i = 0;
+#ifdef DBFLIB_SSE2
+                if (rows == 64 && span <= std::numeric_limits<CodeType>::max()) {
+                    word = FilterWord(c + row, base, (CodeType)span);
+                    i = rows;
+                }
+#endif
+                for (; i < rows; i++) {
+                    if ((uint64_t)(CodeType)(c[row + i] - base) < span) {
+                        word |= 1ull << i;
+                    }
+                }
+                bitmap[w] = word;
+                matches += std::popcount(word);
+                row += rows;
+            }
+            return matches;
+        }
+
+#ifdef DBFLIB_SSE2
+        // filter 64 codes, the unsigned comparisons are done as signed comparisons with the sign bit flipped
+        template<typename CodeType>
+        static uint64_t FilterWord(const CodeType* c, CodeType base, CodeType span) {
+            uint64_t word = 0;
+            if constexpr (sizeof(CodeType) == 1) {
+                const __m128i flip = _mm_set1_epi8((char)0x80);
+                const __m128i vbase = _mm_set1_epi8((char)base);
+                const __m128i vspan = _mm_xor_si128(_mm_set1_epi8((char)span), flip);
+                for (size_t i = 0; i < 64; i += 16) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+                    v = _mm_xor_si128(_mm_sub_epi8(v, vbase), flip);
+                    word |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_cmplt_epi8(v, vspan)) << i;
+                }
+            } else if constexpr (sizeof(CodeType) == 2) {
+                const __m128i flip = _mm_set1_epi16((short)0x8000);
+                const __m128i vbase = _mm_set1_epi16((short)base);
+                const __m128i vspan = _mm_xor_si128(_mm_set1_epi16((short)span), flip);
+                for (size_t i = 0; i < 64; i += 16) {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i + 8));
+                    a = _mm_cmplt_epi16(_mm_xor_si128(_mm_sub_epi16(a, vbase), flip), vspan);
+                    b = _mm_cmplt_epi16(_mm_xor_si128(_mm_sub_epi16(b, vbase), flip), vspan);
+                    word |= (uint64_t)(uint16_t)_mm_movemask_epi8(_mm_packs_epi16(a, b)) << i;
+                }
+            } else {
+                const __m128i flip = _mm_set1_epi32(INT32_MIN);
+                const __m128i vbase = _mm_set1_epi32((int)base);
+                const __m128i vspan = _mm_xor_si128(_mm_set1_epi32((int)span), flip);
+                for (size_t i = 0; i < 64; i += 4) {
+                    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i));
+                    v = _mm_cmplt_epi32(_mm_xor_si128(_mm_sub_epi32(v, vbase), flip), vspan);
+                    word |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(v)) << i;
+                }
+            }
+            return word;
+        }
+#endif
+    };
+
+    /*
+     * Create a dictionary encoded string column.
+     * @param builder builder
+     * @param values row values, the elements should be convertible to std::string_view
+     * @return block id of the DB_DICTIONARY_COLUMN
+     */
+    template<typename Values>
+    BlockId CreateDictionaryColumn(DBFileBuilder& builder, const Values& values) {
+        std::vector<std::string_view> rows{};
+        for (const auto& value : values) {
+            rows.emplace_back(value);
+        }
+        std::vector<std::string_view> dictionary{ rows };
+        std::sort(dictionary.begin(), dictionary.end());
+        dictionary.erase(std::unique(dictionary.begin(), dictionary.end()), dictionary.end());
+        if (dictionary.size() >= DB_DICTIONARY_COLUMN::npos) {
+            DBFLIB_THROW("too many dictionary values");
+        }
+
+        std::unordered_map<std::string_view, uint32_t> codes{};
+        std::vector<uint32_t> offsets{};
+        std::vector<char> strings{};
+        codes.reserve(dictionary.size());
+        for (std::string_view value : dictionary) {
+            codes[value] = (uint32_t)offsets.size();
+            offsets.push_back((uint32_t)strings.size());
+            strings.insert(strings.end(), value.begin(), value.end());
+            if (strings.size() > INT32_MAX) {
+                DBFLIB_THROW("file too big");
+            }
+        }
+        offsets.push_back((uint32_t)strings.size());
+        strings.push_back(0);
+
+        uint32_t width = dictionary.size() <= 0x100 ? 1 : dictionary.size() <= 0x10000 ? 2 : 4;
+        if (rows.size() * width > INT32_MAX) {
+            DBFLIB_THROW("file too big");
+        }
+        std::vector<uint8_t> encoded(rows.size() * width + sizeof(uint32_t));
+        for (size_t i = 0; i < rows.size(); i++) {
+            uint32_t code = codes[rows[i]];
+            switch (width) {
+            case 1: encoded[i] = (uint8_t)code; break;
+            case 2: reinterpret_cast<uint16_t*>(encoded.data())[i] = (uint16_t)code; break;
+            default: reinterpret_cast<uint32_t*>(encoded.data())[i] = code; break;
+            }
+        }
+
+        builder.AlignBlock();
+        auto [columnId, column] = builder.CreateBlock<DB_DICTIONARY_COLUMN>();
+        column->row_count = rows.size();
+        column->dictionary_size = (uint32_t)dictionary.size();
+        column->code_width = width;
+
+        builder.AlignBlock();
+        BlockId codesId = builder.CreateBlock(encoded.data(), encoded.size());
+        builder.AlignBlock();
+        BlockId offsetsId = builder.CreateBlock(offsets.data(), offsets.size() * sizeof(offsets[0]));
+        BlockId stringsId = builder.CreateBlock(strings.data(), strings.size());
+        builder.CreateLink(columnId, offsetof(DB_DICTIONARY_COLUMN, offsets), offsetsId);
+        builder.CreateLink(columnId, offsetof(DB_DICTIONARY_COLUMN, strings), stringsId);
+        builder.CreateLink(columnId, offsetof(DB_DICTIONARY_COLUMN, codes), codesId);
+
+        return columnId;
+    }
+}
@@ -0,0 +1,353 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * Parallel executors used by the bulk operations
+ */
+namespace dbflib {
+    /*
+     * Executor interface, an executor runs indexed tasks and returns once they are all done.
+     */
+    class DBExecutor {
+    public:
+        virtual ~DBExecutor() = default;
+
+        /*
+         * @return max thread count running the tasks, including the calling thread
+         */
+        virtual size_t Concurrency() const = 0;
+
+        /*
+         * Run tasks, the calling thread can run some of them. The first exception thrown by a task is rethrown.
+         * @param count task count
+         * @param task task (size_t index)
+         */
+        virtual void Run(size_t count, const std::function<void(size_t)>& task) = 0;
+    };
+
+    /*
+     * Executor running the tasks on the calling thread
+     */
+    class DBSerialExecutor : public DBExecutor {
+    public:
+        size_t Concurrency() const override {
+            return 1;
+        }
+
+        void Run(size_t count, const std::function<void(size_t)>& task) override {
+            for (size_t i = 0; i < count; i++) {
+                task(i);
+            }
+        }
+    };
+
+    /*
+     * Work stealing thread pool. A run is pushed as one task range, the workers are splitting their ranges in halves
+     * and the idle workers are stealing the oldest ranges of the others. The calling thread is also running tasks
+     * while waiting, so nested runs from a task don't block a worker.
+     */
+    class DBWorkStealingExecutor : public DBExecutor {
+        struct Batch {
+            const std::function<void(size_t)>* task;
+            size_t count;
+            std::atomic<size_t> done{};
+            std::mutex errorMutex{};
+            std::exception_ptr error{};
+        };
+
+        struct Job {
+            Batch* batch;
+            size_t begin;
+            size_t end;
+        };
+
+        struct Queue {
+            std::mutex mutex{};
+            std::deque<Job> jobs{};
+        };
+
+        // one queue per worker + the queue of the external threads
+        std::vector<std::unique_ptr<Queue>> queues{};
+        std::vector<std::thread> workers{};
+        std::mutex mutex{};
+        std::condition_variable workCv{};
+        std::condition_variable doneCv{};
+        std::atomic<size_t> pending{};
+        bool stop{};
+
+        struct Current {
+            DBWorkStealingExecutor* executor;
+            size_t queue;
+        };
+
+        static Current& CurrentWorker() {
+            static thread_local Current current{};
+            return current;
+        }
+
+        size_t QueueOfThread() {
+            Current& current = CurrentWorker();
+            return current.executor == this ? current.queue : queues.size() - 1;
+        }
+
+        void Push(size_t queue, const Job& job) {
+            {
+                std::lock_guard lock{ queues[queue]->mutex };
+                queues[queue]->jobs.push_back(job);
+            }
+            pending.fetch_add(1, std::memory_order_release);
+            {
+                // avoid a lost wake up between the pending check and the wait of a worker
+                std::lock_guard lock{ mutex };
+            }
+            workCv.notify_one();
+        }
+
+        bool Take(size_t queue, Job& job) {
+            if (!pending.load(std::memory_order_acquire)) {
+                return false;
+            }
+            {
+                // newest job of the own queue
+                Queue& own = *queues[queue];
+                std::lock_guard lock{ own.mutex };
+                if (!own.jobs.empty()) {
+                    job = own.jobs.back();
+                    own.jobs.pop_back();
+                    pending.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            // oldest job of another queue
+            for (size_t i = 1; i < queues.size(); i++) {
+                Queue& other = *queues[(queue + i) % queues.size()];
+                std::lock_guard lock{ other.mutex };
+                if (!other.jobs.empty()) {
+                    job = other.jobs.front();
+                    other.jobs.pop_front();
+                    pending.fetch_sub(1, std::memory_order_relaxed);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void Execute(size_t queue, Job job) {
+            // keep the first half and share the second
+            while (job.end - job.begin > 1) {
+                size_t mid = job.begin + (job.end - job.begin) / 2;
+                Push(queue, Job{ job.batch, mid, job.end });
+                job.end = mid;
+            }
+            Batch& batch = *job.batch;
+            // the batch can be released by its caller once the last task is done
+            size_t count = batch.count;
+#ifdef __cpp_exceptions
+            try {
+                (*batch.task)(job.begin);
+            } catch (...) {
+                std::lock_guard lock{ batch.errorMutex };
+                if (!batch.error) {
+                    batch.error = std::current_exception();
+                }
+            }
+#else
+            (*batch.task)(job.begin);
+#endif
+            if (batch.done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                {
+                    std::lock_guard lock{ mutex };
+                }
+                doneCv.notify_all();
+            }
+        }
+
+        void Worker(size_t queue) {
+            CurrentWorker() = Current{ this, queue };
+            Job job;
+            while (true) {
+                if (Take(queue, job)) {
+                    Execute(queue, job);
+                    continue;
+                }
+                std::unique_lock lock{ mutex };
+                workCv.wait(lock, [this]() { return stop || pending.load(std::memory_order_acquire); });
+                if (stop) {
+                    return;
+                }
+            }
+        }
+    public:
+        /*
+         * @param threads worker count, the calling thread of a run is also running tasks
+         */
+        DBWorkStealingExecutor(size_t threads) {
+            for (size_t i = 0; i <= threads; i++) {
+                queues.emplace_back(std::make_unique<Queue>());
+            }
+            for (size_t i = 0; i < threads; i++) {
+                workers.emplace_back(&DBWorkStealingExecutor::Worker, this, i);
+            }
+        }
+
+        DBWorkStealingExecutor(DBWorkStealingExecutor& o) = delete;
+        DBWorkStealingExecutor(DBWorkStealingExecutor&& o) = delete;
+
+        ~DBWorkStealingExecutor() {
+            {
+                std::lock_guard lock{ mutex };
+                stop = true;
+            }
+            workCv.notify_all();
+            for (std::thread& worker : workers) {
+                worker.join();
+            }
+        }
+
+        size_t Concurrency() const override {
+            return workers.size() + 1;
+        }
+
+        void Run(size_t count, const std::function<void(size_t)>& task) override {
+            if (!count) {
+                return;
+            }
+            Batch batch{ &task, count };
+            size_t queue = QueueOfThread();
+            Execute(queue, Job{ &batch, 0, count });
+
+            Job job;
+            while (batch.done.load(std::memory_order_acquire) != count) {
+                if (Take(queue, job)) {
+                    Execute(queue, job);
+                    continue;
+                }
+                std::unique_lock lock{ mutex };
+                doneCv.wait(lock, [this, &batch, count]() {
+                    return batch.done.load(std::memory_order_acquire) == count || pending.load(std::memory_order_acquire);
+                });
+            }
+#ifdef __cpp_exceptions
+            if (batch.error) {
+                std::rethrow_exception(batch.error);
+            }
+#endif
+        }
+    };
+
+    /*
+     * Adapter for a user thread pool, the tasks are claimed by the calling thread and by jobs submitted to the pool.
+     */
+    class DBSubmitExecutor : public DBExecutor {
+        std::function<void(std::function<void()>)> submit;
+        size_t concurrency;
+    public:
+        /*
+         * @param submit function submitting a job to the user pool
+         * @param concurrency thread count of the user pool
+         */
+        DBSubmitExecutor(std::function<void(std::function<void()>)> submit, size_t concurrency)
+            : submit(std::move(submit)), concurrency(std::max<size_t>(1, concurrency)) {}
+
+        size_t Concurrency() const override {
+            return concurrency + 1;
+        }
+
+        void Run(size_t count, const std::function<void(size_t)>& task) override {
+            if (!count) {
+                return;
+            }
+            // the submitted jobs can start after the end of the run, they only access the shared state
+            struct State {
+                const std::function<void(size_t)>* task;
+                size_t count;
+                std::atomic<size_t> next{};
+                std::atomic<size_t> done{};
+                std::mutex mutex{};
+                std::condition_variable cv{};
+                std::exception_ptr error{};
+
+                void Claim() {
+                    size_t i;
+                    while ((i = next.fetch_add(1, std::memory_order_relaxed)) < count) {
+#ifdef __cpp_exceptions
+                        try {
+                            (*task)(i);
+                        } catch (...) {
+                            std::lock_guard lock{ mutex };
+                            if (!error) {
+                                error = std::current_exception();
+                            }
+                        }
+#else
+                        (*task)(i);
+#endif
+                        if (done.fetch_add(1, std::memory_order_acq_rel) + 1 == count) {
+                            std::lock_guard lock{ mutex };
+                            cv.notify_all();
+                        }
+                    }
+                }
+            };
+            auto state = std::make_shared<State>();
+            state->task = &task;
+            state->count = count;
+            for (size_t i = 1; i < std::min(count, Concurrency()); i++) {
+                submit([state]() { state->Claim(); });
+            }
+            state->Claim();
+            std::unique_lock lock{ state->mutex };
+            state->cv.wait(lock, [&state, count]() { return state->done.load(std::memory_order_acquire) == count; });
+#ifdef __cpp_exceptions
+            if (state->error) {
+                std::rethrow_exception(state->error);
+            }
+#endif
+        }
+    };
+
+    /*
+     * Shared executor used by default by the bulk operations, one pool for the process to avoid the oversubscription
+     * when multiple files are processed at the same time.
+     * @return executor
+     */
+    inline DBExecutor& DefaultExecutor() {
+        static DBWorkStealingExecutor executor{ std::max<size_t>(1, std::thread::hardware_concurrency()) - 1 };
+        return executor;
+    }
+
+    /*
+     * Run a function over a range split in chunks
+     * @param executor executor
+     * @param count range size
+     * @param grain min chunk size, a range smaller than the grain is run by the calling thread
+     * @param func function (size_t begin, size_t end)
+     */
+    template<typename Func>
+    void ParallelFor(DBExecutor& executor, size_t count, size_t grain, Func&& func) {
+        grain = std::max<size_t>(1, grain);
+        size_t concurrency = executor.Concurrency();
+        if (count <= grain || concurrency <= 1) {
+            if (count) {
+                func((size_t)0, count);
+            }
+            return;
+        }
+        // a few chunks per thread to balance uneven chunks
+        size_t chunks = std::min((count + grain - 1) / grain, concurrency * 4);
+        size_t chunk = (count + chunks - 1) / chunks;
+        chunks = (count + chunk - 1) / chunk;
+        executor.Run(chunks, [&func, count, chunk](size_t i) {
+            func(i * chunk, std::min(count, (i + 1) * chunk));
+        });
+    }
+}
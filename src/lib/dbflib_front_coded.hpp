@@ -0,0 +1,216 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+/*
+ * Front coded sorted string table blocks
+ */
+namespace dbflib {
+    /*
+     * Sorted string table compressed by buckets of bucket_size strings.
+     *
+     * The first string of a bucket is stored as varint(length) + bytes, the next strings are stored as
+     * varint(shared prefix with the previous string) + varint(suffix length) + suffix bytes.
+     */
+    struct DB_FRONT_CODED {
+        static constexpr uint32_t npos = UINT32_MAX;
+
+        uint32_t count{};
+        uint32_t bucket_size{};
+        uint32_t bucket_count{};
+        uint32_t data_size{};
+        uint32_t* buckets{};
+        uint8_t* data{};
+
+        /*
+         * Find a string
+         * @param key string
+         * @return index of the string or npos if the string isn't in the table
+         */
+        uint32_t Find(std::string_view key) const {
+            if (!count) {
+                return npos;
+            }
+            // last bucket with head <= key
+            uint32_t lo = 0;
+            uint32_t hi = bucket_count;
+            while (hi - lo > 1) {
+                uint32_t mid = (lo + hi) / 2;
+                if (Head(mid) <= key) {
+                    lo = mid;
+                } else {
+                    hi = mid;
+                }
+            }
+
+            const uint8_t* ptr = data + buckets[lo];
+            size_t len = utils::ReadVarInt(ptr);
+            size_t l = 0;
+            uint32_t index = lo * bucket_size;
+            uint32_t end = std::min(index + bucket_size, count);
+
+            // l is the common prefix of the current string and the key, the current string is lower than the key
+            for (;;) {
+                // ptr is the start of the current string bytes after the position l
+                size_t m = utils::CommonPrefixLength(ptr, key.data() + l, std::min(len, key.size()) - l);
+                if (l + m == len && l + m == key.size()) {
+                    return index;
+                }
+                if (l + m == key.size() || (l + m < len && ptr[m] > (uint8_t)key[l + m])) {
+                    return npos; // current > key
+                }
+                ptr += len - l;
+                l += m;
+
+                for (;;) {
+                    if (++index == end) {
+                        return npos;
+                    }
+                    size_t shared = utils::ReadVarInt(ptr);
+                    size_t suffix = utils::ReadVarInt(ptr);
+                    if (shared < l) {
+                        // the next string is greater than the current string at a position shared with the key
+                        return npos;
+                    }
+                    len = shared + suffix;
+                    if (shared == l) {
+                        break;
+                    }
+                    // shared > l, the next string compares like the current string
+                    ptr += suffix;
+                }
+            }
+        }
+
+        /*
+         * Test if a string is in the table
+         * @param key string
+         * @return true if the string is in the table
+         */
+        bool Contains(std::string_view key) const {
+            return Find(key) != npos;
+        }
+
+        /*
+         * Decode a string
+         * @param index string index, should be lower than count
+         * @param out string output
+         */
+        void Get(uint32_t index, std::string& out) const {
+            uint32_t bucket = index / bucket_size;
+            const uint8_t* ptr = data + buckets[bucket];
+            size_t len = utils::ReadVarInt(ptr);
+            out.assign(reinterpret_cast<const char*>(ptr), len);
+            ptr += len;
+            for (uint32_t i = bucket * bucket_size; i < index; i++) {
+                size_t shared = utils::ReadVarInt(ptr);
+                size_t suffix = utils::ReadVarInt(ptr);
+                out.resize(shared);
+                out.append(reinterpret_cast<const char*>(ptr), suffix);
+                ptr += suffix;
+            }
+        }
+
+        /*
+         * Decode a string
+         * @param index string index, should be lower than count
+         * @return string
+         */
+        std::string Get(uint32_t index) const {
+            std::string out{};
+            Get(index, out);
+            return out;
+        }
+
+        /*
+         * Decode all the strings in order
+         * @param func callback (std::string_view str, uint32_t index)
+         */
+        template<typename Func>
+        void ForEach(Func&& func) const {
+            std::string cur{};
+            const uint8_t* ptr = data;
+            for (uint32_t i = 0; i < count; i++) {
+                if (i % bucket_size == 0) {
+                    size_t len = utils::ReadVarInt(ptr);
+                    cur.assign(reinterpret_cast<const char*>(ptr), len);
+                    ptr += len;
+                } else {
+                    size_t shared = utils::ReadVarInt(ptr);
+                    size_t suffix = utils::ReadVarInt(ptr);
+                    cur.resize(shared);
+                    cur.append(reinterpret_cast<const char*>(ptr), suffix);
+                    ptr += suffix;
+                }
+                func(std::string_view{ cur }, i);
+            }
+        }
+
+    private:
+        std::string_view Head(uint32_t bucket) const {
+            const uint8_t* ptr = data + buckets[bucket];
+            size_t len = utils::ReadVarInt(ptr);
+            return std::string_view{ reinterpret_cast<const char*>(ptr), len };
+        }
+    };
+
+    /*
+     * Create a front coded string table.
+     * @param builder builder
+     * @param strings sorted strings, the elements should be convertible to std::string_view
+     * @param bucketSize strings per bucket
+     * @return block id of the DB_FRONT_CODED
+     */
+    template<typename Strings>
+    BlockId CreateFrontCoded(DBFileBuilder& builder, const Strings& strings, uint32_t bucketSize = 16) {
+        if (!bucketSize) {
+            DBFLIB_THROW("invalid front coding bucket size");
+        }
+        std::vector<uint8_t> data{};
+        std::vector<uint32_t> buckets{};
+        std::string_view prev{};
+        size_t count{};
+
+        for (const auto& str : strings) {
+            std::string_view s{ str };
+            if (count && s < prev) {
+                DBFLIB_THROW("front coded strings should be sorted");
+            }
+            if (count % bucketSize == 0) {
+                buckets.push_back((uint32_t)data.size());
+                utils::WriteVarInt(data, s.size());
+                data.insert(data.end(), s.begin(), s.end());
+            } else {
+                size_t shared = utils::CommonPrefixLength(prev.data(), s.data(), std::min(prev.size(), s.size()));
+                utils::WriteVarInt(data, shared);
+                utils::WriteVarInt(data, s.size() - shared);
+                data.insert(data.end(), s.begin() + shared, s.end());
+            }
+            if (data.size() > INT32_MAX) {
+                DBFLIB_THROW("file too big");
+            }
+            prev = s;
+            count++;
+        }
+        buckets.push_back((uint32_t)data.size());
+        // padding to always have a valid pointer
+        data.push_back(0);
+
+        builder.AlignBlock();
+        auto [tableId, table] = builder.CreateBlock<DB_FRONT_CODED>();
+        table->count = (uint32_t)count;
+        table->bucket_size = bucketSize;
+        table->bucket_count = (uint32_t)buckets.size() - 1;
+        table->data_size = (uint32_t)data.size() - 1;
+
+        BlockId bucketsId = builder.CreateBlock(buckets.data(), buckets.size() * sizeof(buckets[0]));
+        BlockId dataId = builder.CreateBlock(data.data(), data.size());
+        builder.CreateLink(tableId, offsetof(DB_FRONT_CODED, buckets), bucketsId);
+        builder.CreateLink(tableId, offsetof(DB_FRONT_CODED, data), dataId);
+
+        return tableId;
+    }
+}
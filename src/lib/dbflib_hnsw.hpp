@@ -0,0 +1,478 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <random>
+#include <span>
+
+/*
+ * Hierarchical navigable small world (HNSW) vector index blocks
+ */
+namespace dbflib {
+    enum DB_HNSW_QUANTIZATION : uint32_t {
+        // vectors stored as float
+        DBHQ_FLOAT32 = 0,
+        // vectors stored as int8_t with a float scale per vector
+        DBHQ_INT8 = 1,
+    };
+
+    namespace hnsw {
+        /*
+         * Squared euclidean distance
+         * @param a first vector
+         * @param b second vector
+         * @param dimension vector dimension
+         * @return distance
+         */
+        inline float L2Squared(const float* a, const float* b, size_t dimension) {
+            size_t i = 0;
+            float sum = 0;
+#if defined(DBFLIB_AVX2)
+            __m256 acc = _mm256_setzero_ps();
+            for (; i + 8 <= dimension; i += 8) {
+                __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(d, d));
+            }
+            __m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+#elif defined(DBFLIB_SSE2)
+            __m128 acc4 = _mm_setzero_ps();
+#endif
+#if defined(DBFLIB_SSE2)
+            for (; i + 4 <= dimension; i += 4) {
+                __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+                acc4 = _mm_add_ps(acc4, _mm_mul_ps(d, d));
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, acc4);
+            sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+            for (; i < dimension; i++) {
+                float d = a[i] - b[i];
+                sum += d * d;
+            }
+            return sum;
+        }
+
+        /*
+         * Squared euclidean distance with a quantized vector
+         * @param a vector
+         * @param b quantized vector
+         * @param scale scale of the quantized vector
+         * @param dimension vector dimension
+         * @return distance
+         */
+        inline float L2Squared(const float* a, const int8_t* b, float scale, size_t dimension) {
+            size_t i = 0;
+            float sum = 0;
+#if defined(DBFLIB_AVX2)
+            __m256 acc = _mm256_setzero_ps();
+            __m256 s = _mm256_set1_ps(scale);
+            for (; i + 8 <= dimension; i += 8) {
+                __m128i q = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(b + i));
+                __m256 vb = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(q)), s);
+                __m256 d = _mm256_sub_ps(_mm256_loadu_ps(a + i), vb);
+                acc = _mm256_add_ps(acc, _mm256_mul_ps(d, d));
+            }
+            __m128 acc4 = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+#elif defined(DBFLIB_SSE2)
+            __m128 acc4 = _mm_setzero_ps();
+#endif
+#if defined(DBFLIB_SSE2)
+            __m128 s4 = _mm_set1_ps(scale);
+            for (; i + 4 <= dimension; i += 4) {
+                int32_t packed;
+                std::memcpy(&packed, b + i, sizeof(packed));
+                // sign extend the bytes, each byte is moved to the top of its lane and shifted back
+                __m128i q = _mm_cvtsi32_si128(packed);
+                q = _mm_unpacklo_epi16(_mm_unpacklo_epi8(q, q), _mm_unpacklo_epi8(q, q));
+                __m128 vb = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(q, 24)), s4);
+                __m128 d = _mm_sub_ps(_mm_loadu_ps(a + i), vb);
+                acc4 = _mm_add_ps(acc4, _mm_mul_ps(d, d));
+            }
+            float lanes[4];
+            _mm_storeu_ps(lanes, acc4);
+            sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+            for (; i < dimension; i++) {
+                float d = a[i] - b[i] * scale;
+                sum += d * d;
+            }
+            return sum;
+        }
+
+        /*
+         * Reusable visited set
+         */
+        class VisitedSet {
+            std::vector<uint32_t> marks{};
+            uint32_t epoch{};
+        public:
+            /*
+             * Clear the set
+             * @param size element count
+             */
+            void Reset(size_t size) {
+                if (marks.size() < size) {
+                    marks.resize(size);
+                }
+                if (++epoch == 0) {
+                    std::fill(marks.begin(), marks.end(), 0);
+                    epoch = 1;
+                }
+            }
+
+            /*
+             * Insert an element
+             * @param id element
+             * @return true if the element wasn't in the set
+             */
+            bool Insert(uint32_t id) {
+                if (marks[id] == epoch) {
+                    return false;
+                }
+                marks[id] = epoch;
+                return true;
+            }
+        };
+
+        typedef std::pair<float, uint32_t> Candidate;
+
+        /*
+         * Search a layer of the graph
+         * @param entries entry points, with their distances
+         * @param ef result size
+         * @param visited visited set, reset by the caller
+         * @param distance distance to the query (uint32_t id) -> float
+         * @param neighbors neighbors of a node in the layer (uint32_t id, callback(uint32_t neighbor))
+         * @return closest nodes, sorted by distance
+         */
+        template<typename DistanceFunc, typename NeighborsFunc>
+        std::vector<Candidate> SearchLayer(const std::vector<Candidate>& entries, size_t ef, VisitedSet& visited, DistanceFunc&& distance, NeighborsFunc&& neighbors) {
+            std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> candidates{};
+            std::priority_queue<Candidate> results{};
+            for (const Candidate& e : entries) {
+                visited.Insert(e.second);
+                candidates.push(e);
+                results.push(e);
+            }
+            while (results.size() > ef) {
+                results.pop();
+            }
+
+            while (!candidates.empty()) {
+                Candidate c = candidates.top();
+                if (c.first > results.top().first && results.size() >= ef) {
+                    break;
+                }
+                candidates.pop();
+                neighbors(c.second, [&](uint32_t n) {
+                    if (!visited.Insert(n)) {
+                        return;
+                    }
+                    float d = distance(n);
+                    if (results.size() < ef || d < results.top().first) {
+                        candidates.emplace(d, n);
+                        results.emplace(d, n);
+                        if (results.size() > ef) {
+                            results.pop();
+                        }
+                    }
+                });
+            }
+
+            std::vector<Candidate> out(results.size());
+            for (size_t i = out.size(); i-- > 0;) {
+                out[i] = results.top();
+                results.pop();
+            }
+            return out;
+        }
+    }
+
+    /*
+     * HNSW index, the layer 0 neighbors of the node n are level0[n * (m0 + 1)], one count followed by m0 slots.
+     * The node n has (upper_offsets[n + 1] - upper_offsets[n]) / (m + 1) upper layers stored in upper with the same layout.
+     */
+    struct DB_HNSW {
+        uint32_t dimension{};
+        uint32_t count{};
+        uint32_t m{};
+        uint32_t m0{};
+        uint32_t max_level{};
+        uint32_t entry_point{};
+        uint32_t quantization{};
+        uint32_t __pad{};
+        void* vectors{};
+        float* scales{};
+        uint32_t* level0{};
+        uint32_t* upper_offsets{};
+        uint32_t* upper{};
+
+        /*
+         * Reusable search state, a context can't be used by 2 threads at the same time
+         */
+        struct SearchContext {
+            hnsw::VisitedSet visited{};
+        };
+
+        /*
+         * Distance between a query and a stored vector
+         * @param query query, dimension values
+         * @param id vector id
+         * @return squared euclidean distance
+         */
+        float Distance(const float* query, uint32_t id) const {
+            if (quantization == DBHQ_INT8) {
+                return hnsw::L2Squared(query, reinterpret_cast<const int8_t*>(vectors) + (size_t)id * dimension, scales[id], dimension);
+            }
+            return hnsw::L2Squared(query, reinterpret_cast<const float*>(vectors) + (size_t)id * dimension, dimension);
+        }
+
+        /*
+         * Iterate over the neighbors of a node
+         * @param id node
+         * @param level layer
+         * @param func callback (uint32_t neighbor)
+         */
+        template<typename Func>
+        void ForEachNeighbor(uint32_t id, uint32_t level, Func&& func) const {
+            const uint32_t* list;
+            if (level) {
+                list = upper + upper_offsets[id] + (size_t)(level - 1) * (m + 1);
+            } else {
+                list = level0 + (size_t)id * (m0 + 1);
+            }
+            for (uint32_t i = 1; i <= list[0]; i++) {
+                func(list[i]);
+            }
+        }
+
+        /*
+         * Get the top layer of a node
+         * @param id node
+         * @return level
+         */
+        uint32_t Level(uint32_t id) const {
+            return (upper_offsets[id + 1] - upper_offsets[id]) / (m + 1);
+        }
+
+        /*
+         * Search the approximate nearest neighbors of a vector
+         * @param query query, dimension values
+         * @param k neighbor count
+         * @param ef search size, higher values are slower with a better recall
+         * @param context search context to reuse, nullptr to use a temporary context
+         * @return (squared distance, id) of the neighbors, sorted by distance
+         */
+        std::vector<std::pair<float, uint32_t>> Search(const float* query, size_t k, size_t ef = 64, SearchContext* context = nullptr) const {
+            if (!count || !k) {
+                return {};
+            }
+            SearchContext localContext{};
+            if (!context) {
+                context = &localContext;
+            }
+            auto distance = [this, query](uint32_t id) { return Distance(query, id); };
+
+            std::vector<hnsw::Candidate> entries{ { distance(entry_point), entry_point } };
+            for (uint32_t level = max_level; level > 0; level--) {
+                context->visited.Reset(count);
+                entries = hnsw::SearchLayer(entries, 1, context->visited, distance, [this, level](uint32_t id, auto&& func) {
+                    ForEachNeighbor(id, level, func);
+                });
+            }
+            context->visited.Reset(count);
+            std::vector<hnsw::Candidate> results = hnsw::SearchLayer(entries, std::max(ef, k), context->visited, distance, [this](uint32_t id, auto&& func) {
+                ForEachNeighbor(id, 0, func);
+            });
+            if (results.size() > k) {
+                results.resize(k);
+            }
+            return results;
+        }
+    };
+
+    struct DB_HNSW_OPTIONS {
+        // max neighbors per node in the upper layers, the layer 0 is using 2 * m
+        uint32_t m = 16;
+        // search size during the construction
+        uint32_t ef_construction = 100;
+        // stored vectors format
+        DB_HNSW_QUANTIZATION quantization = DBHQ_FLOAT32;
+        // level generator seed
+        uint64_t seed = 42;
+    };
+
+    /*
+     * Build an HNSW index.
+     * @param builder builder
+     * @param vectors vectors, count * dimension values
+     * @param dimension vector dimension
+     * @param options index options
+     * @return block id of the DB_HNSW
+     */
+    inline BlockId CreateHnsw(DBFileBuilder& builder, std::span<const float> vectors, uint32_t dimension, const DB_HNSW_OPTIONS& options = {}) {
+        if (!dimension || vectors.size() % dimension) {
+            DBFLIB_THROW("invalid vector dimension");
+        }
+        if (options.m < 2) {
+            DBFLIB_THROW("invalid hnsw m parameter");
+        }
+        const uint32_t count = (uint32_t)(vectors.size() / dimension);
+        const uint32_t m = options.m;
+        const uint32_t m0 = options.m * 2;
+        const float* data = vectors.data();
+        auto vec = [data, dimension](uint32_t id) { return data + (size_t)id * dimension; };
+
+        std::mt19937_64 rnd{ options.seed };
+        std::uniform_real_distribution<double> uniform{ 0.0, 1.0 };
+        double levelMult = 1 / std::log((double)m);
+
+        // links[node][level]
+        std::vector<std::vector<std::vector<uint32_t>>> links(count);
+        uint32_t entryPoint = 0;
+        uint32_t maxLevel = 0;
+        hnsw::VisitedSet visited{};
+
+        // keep the candidates not closer to a selected neighbor than to the base, then fill with the closest ones
+        auto selectNeighbors = [&](const std::vector<hnsw::Candidate>& candidates, size_t max) {
+            std::vector<uint32_t> selected{};
+            std::vector<uint32_t> pruned{};
+            for (const hnsw::Candidate& c : candidates) {
+                if (selected.size() >= max) {
+                    break;
+                }
+                bool good = true;
+                for (uint32_t s : selected) {
+                    if (hnsw::L2Squared(vec(c.second), vec(s), dimension) < c.first) {
+                        good = false;
+                        break;
+                    }
+                }
+                (good ? selected : pruned).push_back(c.second);
+            }
+            for (size_t i = 0; i < pruned.size() && selected.size() < max; i++) {
+                selected.push_back(pruned[i]);
+            }
+            return selected;
+        };
+
+        for (uint32_t id = 0; id < count; id++) {
+            uint32_t level = (uint32_t)(-std::log(std::max(uniform(rnd), 1e-12)) * levelMult);
+            links[id].resize(level + 1ull);
+            if (!id) {
+                maxLevel = level;
+                continue;
+            }
+
+            const float* q = vec(id);
+            auto distance = [&](uint32_t o) { return hnsw::L2Squared(q, vec(o), dimension); };
+            std::vector<hnsw::Candidate> entries{ { distance(entryPoint), entryPoint } };
+
+            for (uint32_t l = maxLevel; l > level; l--) {
+                visited.Reset(count);
+                entries = hnsw::SearchLayer(entries, 1, visited, distance, [&links, l](uint32_t o, auto&& func) {
+                    for (uint32_t n : links[o][l]) func(n);
+                });
+            }
+            for (uint32_t l = std::min(level, maxLevel) + 1; l-- > 0;) {
+                visited.Reset(count);
+                entries = hnsw::SearchLayer(entries, options.ef_construction, visited, distance, [&links, l](uint32_t o, auto&& func) {
+                    for (uint32_t n : links[o][l]) func(n);
+                });
+                size_t max = l ? m : m0;
+                links[id][l] = selectNeighbors(entries, max);
+
+                for (uint32_t n : links[id][l]) {
+                    std::vector<uint32_t>& nl = links[n][l];
+                    nl.push_back(id);
+                    if (nl.size() > max) {
+                        std::vector<hnsw::Candidate> cs{};
+                        for (uint32_t o : nl) {
+                            cs.emplace_back(hnsw::L2Squared(vec(n), vec(o), dimension), o);
+                        }
+                        std::sort(cs.begin(), cs.end());
+                        nl = selectNeighbors(cs, max);
+                    }
+                }
+            }
+            if (level > maxLevel) {
+                maxLevel = level;
+                entryPoint = id;
+            }
+        }
+
+        // serialize
+        std::vector<uint32_t> level0((size_t)count * (m0 + 1));
+        std::vector<uint32_t> upperOffsets(count + 1ull);
+        std::vector<uint32_t> upper{};
+        for (uint32_t id = 0; id < count; id++) {
+            uint32_t* list = level0.data() + (size_t)id * (m0 + 1);
+            list[0] = (uint32_t)links[id][0].size();
+            std::copy(links[id][0].begin(), links[id][0].end(), list + 1);
+
+            upperOffsets[id] = (uint32_t)upper.size();
+            for (size_t l = 1; l < links[id].size(); l++) {
+                size_t start = upper.size();
+                upper.resize(start + m + 1);
+                upper[start] = (uint32_t)links[id][l].size();
+                std::copy(links[id][l].begin(), links[id][l].end(), upper.begin() + start + 1);
+            }
+        }
+        upperOffsets[count] = (uint32_t)upper.size();
+        // keep a valid pointer without upper layers
+        upper.push_back(0);
+
+        builder.AlignBlock();
+        auto [hnswId, index] = builder.CreateBlock<DB_HNSW>();
+        index->dimension = dimension;
+        index->count = count;
+        index->m = m;
+        index->m0 = m0;
+        index->max_level = maxLevel;
+        index->entry_point = entryPoint;
+        index->quantization = options.quantization;
+
+        builder.AlignBlock();
+        if (options.quantization == DBHQ_INT8) {
+            std::vector<int8_t> quantized(vectors.size());
+            std::vector<float> scales(count + 1ull);
+            for (uint32_t id = 0; id < count; id++) {
+                const float* v = vec(id);
+                float maxAbs = 0;
+                for (size_t i = 0; i < dimension; i++) {
+                    maxAbs = std::max(maxAbs, std::abs(v[i]));
+                }
+                float scale = maxAbs ? maxAbs / 127 : 1;
+                scales[id] = scale;
+                for (size_t i = 0; i < dimension; i++) {
+                    quantized[(size_t)id * dimension + i] = (int8_t)std::lround(v[i] / scale);
+                }
+            }
+            quantized.resize(quantized.size() + 8);
+            BlockId vectorsId = builder.CreateBlock(quantized.data(), quantized.size());
+            builder.AlignBlock();
+            BlockId scalesId = builder.CreateBlock(scales.data(), scales.size() * sizeof(float));
+            builder.CreateLink(hnswId, offsetof(DB_HNSW, vectors), vectorsId);
+            builder.CreateLink(hnswId, offsetof(DB_HNSW, scales), scalesId);
+        } else {
+            std::vector<float> stored{ vectors.begin(), vectors.end() };
+            stored.push_back(0);
+            BlockId vectorsId = builder.CreateBlock(stored.data(), stored.size() * sizeof(float));
+            builder.CreateLink(hnswId, offsetof(DB_HNSW, vectors), vectorsId);
+        }
+
+        builder.AlignBlock();
+        level0.push_back(0);
+        BlockId level0Id = builder.CreateBlock(level0.data(), level0.size() * sizeof(uint32_t));
+        BlockId upperOffsetsId = builder.CreateBlock(upperOffsets.data(), upperOffsets.size() * sizeof(uint32_t));
+        BlockId upperId = builder.CreateBlock(upper.data(), upper.size() * sizeof(uint32_t));
+        builder.CreateLink(hnswId, offsetof(DB_HNSW, level0), level0Id);
+        builder.CreateLink(hnswId, offsetof(DB_HNSW, upper_offsets), upperOffsetsId);
+        builder.CreateLink(hnswId, offsetof(DB_HNSW, upper), upperId);
+
+        return hnswId;
+    }
+}
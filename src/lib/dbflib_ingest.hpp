@@ -0,0 +1,713 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <charconv>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+/*
+ * Bulk ingestion of JSON Lines and CSV inputs
+ */
+namespace dbflib {
+    enum DB_INGEST_FORMAT : uint8_t {
+        // one flat JSON object per line
+        DBIF_JSON_LINES = 0,
+        // RFC 4180 CSV, the first line contains the column names
+        DBIF_CSV,
+    };
+
+    enum DB_INGEST_TYPE : uint32_t {
+        DBIT_INT64 = 1,
+        DBIT_DOUBLE,
+        DBIT_BOOL,
+        DBIT_STRING,
+    };
+
+    /*
+     * String value, null terminated string in the strings block of the table, the empty strings are at offset 0
+     */
+    struct DB_INGEST_STRING {
+        uint32_t offset;
+        uint32_t length;
+    };
+
+    struct DB_INGEST_COLUMN {
+        uint32_t type;
+        uint32_t offset;
+        char* name;
+    };
+
+    /*
+     * Ingested table, each record has a 8 bytes slot per column in the schema order. The int64 and double values are
+     * stored as is, the bools as an uint8_t and the strings as a DB_INGEST_STRING. The missing values are zeroed.
+     */
+    struct DB_INGEST_TABLE {
+        uint64_t count;
+        uint32_t record_size;
+        uint32_t column_count;
+        DB_INGEST_COLUMN* columns;
+        uint8_t* records;
+        char* strings;
+        uint64_t strings_size;
+
+        /*
+         * Get a record
+         * @param RecordType record type
+         * @param id record index
+         * @return record
+         */
+        template<typename RecordType = void>
+        RecordType* Record(size_t id) {
+            return reinterpret_cast<RecordType*>(records + id * record_size);
+        }
+
+        /*
+         * Find a column by name
+         * @param name column name
+         * @return column or nullptr if not found
+         */
+        const DB_INGEST_COLUMN* FindColumn(std::string_view name) const {
+            for (size_t i = 0; i < column_count; i++) {
+                if (name == columns[i].name) {
+                    return &columns[i];
+                }
+            }
+            return nullptr;
+        }
+
+        /*
+         * Get a string value
+         * @param str string
+         * @return string view
+         */
+        std::string_view String(const DB_INGEST_STRING& str) const {
+            return { strings + str.offset, str.length };
+        }
+    };
+
+    /*
+     * Columns of the ingested records, the input fields without column are ignored
+     */
+    class DBIngestSchema {
+    public:
+        struct Column {
+            std::string name;
+            DB_INGEST_TYPE type;
+            uint32_t offset;
+        };
+    private:
+        std::vector<Column> columns{};
+    public:
+        /*
+         * Add a column
+         * @param name column name, JSON key or CSV header
+         * @param type column type
+         * @return this
+         */
+        DBIngestSchema& Add(std::string name, DB_INGEST_TYPE type) {
+            if (type < DBIT_INT64 || type > DBIT_STRING) {
+                DBFLIB_THROW("invalid column type");
+            }
+            columns.emplace_back(std::move(name), type, (uint32_t)(columns.size() * sizeof(uint64_t)));
+            return *this;
+        }
+
+        /*
+         * @return columns
+         */
+        const std::vector<Column>& Columns() const {
+            return columns;
+        }
+
+        /*
+         * @return record size
+         */
+        size_t RecordSize() const {
+            return columns.size() * sizeof(uint64_t);
+        }
+    };
+
+    /*
+     * Parse JSON Lines or CSV inputs into a DB_INGEST_TABLE. The input is split in chunks at the record boundaries,
+     * the chunks are parsed in parallel into their own buffers and the buffers are added to the builder without
+     * copy, so the ingester owns the records until the builder is written.
+     */
+    class DBIngester {
+        struct Chunk {
+            const char* begin{};
+            const char* end{};
+            std::vector<uint8_t> records{};
+            std::string strings{};
+            size_t count{};
+            uint64_t stringsBase{};
+        };
+
+        DBIngestSchema schema;
+        DB_INGEST_FORMAT format;
+        size_t chunkSize;
+        std::unordered_map<std::string_view, size_t> columnsByName{};
+        // schema column of each CSV field, SIZE_MAX for an ignored field
+        std::vector<size_t> csvColumns{};
+        std::vector<Chunk> chunks{};
+        uint64_t recordCount{};
+
+        static bool IsWhitespace(char c) {
+            return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+        }
+
+        static const char* SkipWhitespace(const char* p, const char* end) {
+            while (p < end && IsWhitespace(*p)) {
+                p++;
+            }
+            return p;
+        }
+
+        // first record start after a position, quoted if the position is inside a CSV quoted field
+        static const char* NextRecord(const char* p, const char* end, bool csv, bool quoted) {
+            if (!csv) {
+                // the JSON strings can't contain a raw new line
+                const char* q = utils::FindByte(p, end, '\n');
+                return q == end ? end : q + 1;
+            }
+            while (p < end) {
+                const char* q = utils::FindAnyOf(p, end, '"', '\n', '"');
+                if (q == end) {
+                    return end;
+                }
+                if (*q == '"') {
+                    quoted = !quoted;
+                } else if (!quoted) {
+                    return q + 1;
+                }
+                p = q + 1;
+            }
+            return end;
+        }
+
+        uint8_t* NewRecord(Chunk& chunk) const {
+            size_t offset = chunk.records.size();
+            chunk.records.resize(offset + schema.RecordSize());
+            chunk.count++;
+            return chunk.records.data() + offset;
+        }
+
+        static void Store(Chunk& chunk, uint8_t* record, const DBIngestSchema::Column& column, std::string_view value) {
+            uint8_t* slot = record + column.offset;
+            switch (column.type) {
+            case DBIT_INT64: {
+                int64_t v{};
+                if (!value.empty()) {
+                    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), v);
+                    if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                        DBFLIB_THROW("invalid integer value");
+                    }
+                }
+                std::memcpy(slot, &v, sizeof(v));
+                break;
+            }
+            case DBIT_DOUBLE: {
+                double v{};
+                if (!value.empty()) {
+                    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), v);
+                    if (ec != std::errc{} || ptr != value.data() + value.size()) {
+                        DBFLIB_THROW("invalid double value");
+                    }
+                }
+                std::memcpy(slot, &v, sizeof(v));
+                break;
+            }
+            case DBIT_BOOL:
+                if (value == "true" || value == "1") {
+                    *slot = 1;
+                } else if (!value.empty() && value != "false" && value != "0") {
+                    DBFLIB_THROW("invalid bool value");
+                }
+                break;
+            case DBIT_STRING:
+                if (!value.empty()) {
+                    if (value.size() > UINT32_MAX) {
+                        DBFLIB_THROW("string value too big");
+                    }
+                    DB_INGEST_STRING str{ (uint32_t)chunk.strings.size(), (uint32_t)value.size() };
+                    chunk.strings.append(value);
+                    chunk.strings.push_back('\0');
+                    std::memcpy(slot, &str, sizeof(str));
+                }
+                break;
+            }
+        }
+
+        static void AppendUtf8(std::string& out, uint32_t cp) {
+            if (cp < 0x80) {
+                out.push_back((char)cp);
+            } else if (cp < 0x800) {
+                out.push_back((char)(0xC0 | (cp >> 6)));
+                out.push_back((char)(0x80 | (cp & 0x3F)));
+            } else if (cp < 0x10000) {
+                out.push_back((char)(0xE0 | (cp >> 12)));
+                out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (cp & 0x3F)));
+            } else {
+                out.push_back((char)(0xF0 | (cp >> 18)));
+                out.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (cp & 0x3F)));
+            }
+        }
+
+        static uint32_t ParseHex4(const char* p, const char* end) {
+            uint32_t v{};
+            if (end - p < 4) {
+                DBFLIB_THROW("invalid json: bad unicode escape");
+            }
+            auto [ptr, ec] = std::from_chars(p, p + 4, v, 16);
+            if (ec != std::errc{} || ptr != p + 4) {
+                DBFLIB_THROW("invalid json: bad unicode escape");
+            }
+            return v;
+        }
+
+        // decode a JSON string, p is after the opening quote, return the position after the closing quote
+        static const char* ParseJsonString(const char* p, const char* end, std::string& out) {
+            while (true) {
+                const char* q = utils::FindAnyOf(p, end, '"', '\\', '\n');
+                if (q == end || *q == '\n') {
+                    DBFLIB_THROW("invalid json: unterminated string");
+                }
+                out.append(p, q);
+                if (*q == '"') {
+                    return q + 1;
+                }
+                if (++q == end) {
+                    DBFLIB_THROW("invalid json: unterminated string");
+                }
+                p = q + 1;
+                switch (*q) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp = ParseHex4(p, end);
+                    p += 4;
+                    if (cp >= 0xD800 && cp <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                        uint32_t low = ParseHex4(p + 2, end);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            p += 6;
+                        }
+                    }
+                    AppendUtf8(out, cp);
+                    break;
+                }
+                default:
+                    DBFLIB_THROW("invalid json: bad escape");
+                }
+            }
+        }
+
+        static const char* SkipJsonString(const char* p, const char* end) {
+            while (true) {
+                const char* q = utils::FindAnyOf(p, end, '"', '\\', '\n');
+                if (q == end || *q == '\n') {
+                    DBFLIB_THROW("invalid json: unterminated string");
+                }
+                if (*q == '"') {
+                    return q + 1;
+                }
+                p = q + 2;
+                if (p > end) {
+                    DBFLIB_THROW("invalid json: unterminated string");
+                }
+            }
+        }
+
+        // skip a value, return its end
+        static const char* SkipJsonValue(const char* p, const char* end) {
+            if (*p == '"') {
+                return SkipJsonString(p + 1, end);
+            }
+            if (*p != '{' && *p != '[') {
+                const char* q = utils::FindAnyOf(p, end, ',', '}', '\n');
+                while (q > p && IsWhitespace(q[-1])) {
+                    q--;
+                }
+                return q;
+            }
+            size_t depth = 0;
+            while (p < end) {
+                char c = *p;
+                if (c == '"') {
+                    p = SkipJsonString(p + 1, end);
+                    continue;
+                }
+                if (c == '{' || c == '[') {
+                    depth++;
+                } else if ((c == '}' || c == ']') && !--depth) {
+                    return p + 1;
+                } else if (c == '\n') {
+                    break;
+                }
+                p++;
+            }
+            DBFLIB_THROW("invalid json: unterminated value");
+        }
+
+        void ParseJsonLines(Chunk& chunk) const {
+            std::string key{};
+            std::string value{};
+            const char* p = chunk.begin;
+            const char* end = chunk.end;
+            while ((p = SkipWhitespace(p, end)) < end) {
+                if (*p != '{') {
+                    DBFLIB_THROW("invalid json: expected an object");
+                }
+                uint8_t* record = NewRecord(chunk);
+                p = SkipWhitespace(p + 1, end);
+                if (p < end && *p == '}') {
+                    p++;
+                    continue;
+                }
+                while (true) {
+                    if (p == end || *p != '"') {
+                        DBFLIB_THROW("invalid json: expected a key");
+                    }
+                    key.clear();
+                    p = SkipWhitespace(ParseJsonString(p + 1, end, key), end);
+                    if (p == end || *p != ':') {
+                        DBFLIB_THROW("invalid json: expected ':'");
+                    }
+                    p = SkipWhitespace(p + 1, end);
+                    if (p == end) {
+                        DBFLIB_THROW("invalid json: expected a value");
+                    }
+
+                    auto it = columnsByName.find(key);
+                    if (it == columnsByName.end()) {
+                        p = SkipJsonValue(p, end);
+                    } else {
+                        const DBIngestSchema::Column& column = schema.Columns()[it->second];
+                        if (*p == '"') {
+                            value.clear();
+                            p = ParseJsonString(p + 1, end, value);
+                            Store(chunk, record, column, value);
+                        } else {
+                            const char* q = SkipJsonValue(p, end);
+                            std::string_view token{ p, (size_t)(q - p) };
+                            if ((*p == '{' || *p == '[') && column.type != DBIT_STRING) {
+                                DBFLIB_THROW("invalid json: nested value in a scalar column");
+                            }
+                            if (token != "null") {
+                                Store(chunk, record, column, token);
+                            }
+                            p = q;
+                        }
+                    }
+
+                    p = SkipWhitespace(p, end);
+                    if (p < end && *p == ',') {
+                        p = SkipWhitespace(p + 1, end);
+                        continue;
+                    }
+                    if (p < end && *p == '}') {
+                        p++;
+                        break;
+                    }
+                    DBFLIB_THROW("invalid json: expected ',' or '}'");
+                }
+            }
+        }
+
+        // parse a CSV field, return the position after the field
+        static const char* ParseCsvField(const char* p, const char* end, std::string& scratch, std::string_view& value) {
+            if (p == end || *p != '"') {
+                const char* q = utils::FindAnyOf(p, end, ',', '\n', '\r');
+                value = { p, (size_t)(q - p) };
+                return q;
+            }
+            scratch.clear();
+            p++;
+            while (true) {
+                const char* q = utils::FindByte(p, end, '"');
+                if (q == end) {
+                    DBFLIB_THROW("invalid csv: unterminated quoted field");
+                }
+                scratch.append(p, q);
+                p = q + 1;
+                if (p < end && *p == '"') {
+                    scratch.push_back('"');
+                    p++;
+                } else {
+                    break;
+                }
+            }
+            value = scratch;
+            return p;
+        }
+
+        // move after a field separator, return true if it ends the record
+        static bool NextCsvField(const char*& p, const char* end) {
+            if (p < end && *p == ',') {
+                p++;
+                return false;
+            }
+            if (p < end && *p == '\r') {
+                p++;
+            }
+            if (p < end && *p == '\n') {
+                p++;
+                return true;
+            }
+            if (p == end) {
+                return true;
+            }
+            DBFLIB_THROW("invalid csv: unexpected character after a field");
+        }
+
+        const char* ParseCsvHeader(const char* p, const char* end) {
+            std::string scratch{};
+            csvColumns.clear();
+            bool last = p == end;
+            while (!last) {
+                std::string_view name{};
+                p = ParseCsvField(p, end, scratch, name);
+                auto it = columnsByName.find(name);
+                csvColumns.push_back(it == columnsByName.end() ? SIZE_MAX : it->second);
+                last = NextCsvField(p, end);
+            }
+            return p;
+        }
+
+        void ParseCsv(Chunk& chunk) const {
+            std::string scratch{};
+            const char* p = chunk.begin;
+            const char* end = chunk.end;
+            while (p < end) {
+                // empty lines
+                if (*p == '\n' || (*p == '\r' && end - p > 1 && p[1] == '\n')) {
+                    p += *p == '\n' ? 1 : 2;
+                    continue;
+                }
+                uint8_t* record = NewRecord(chunk);
+                size_t field = 0;
+                bool last = false;
+                while (!last) {
+                    std::string_view value{};
+                    p = ParseCsvField(p, end, scratch, value);
+                    if (field < csvColumns.size() && csvColumns[field] != SIZE_MAX) {
+                        Store(chunk, record, schema.Columns()[csvColumns[field]], value);
+                    }
+                    field++;
+                    last = NextCsvField(p, end);
+                }
+            }
+        }
+    public:
+        /*
+         * @param schema record columns
+         * @param format input format
+         * @param chunkSize size of the input chunks parsed by a task
+         */
+        DBIngester(DBIngestSchema schema, DB_INGEST_FORMAT format, size_t chunkSize = 1 << 20)
+            : schema(std::move(schema)), format(format), chunkSize(std::max<size_t>(1, chunkSize)) {
+            const std::vector<DBIngestSchema::Column>& columns = this->schema.Columns();
+            if (columns.empty()) {
+                DBFLIB_THROW("empty ingest schema");
+            }
+            for (size_t i = 0; i < columns.size(); i++) {
+                if (!columnsByName.emplace(columns[i].name, i).second) {
+                    DBFLIB_THROW("duplicated column name");
+                }
+            }
+        }
+
+        DBIngester(DBIngester& o) = delete;
+        DBIngester(DBIngester&& o) = delete;
+
+        /*
+         * Parse an input into a table, the buffers of the previous ingestion are released. The table is the start
+         * of the file if the builder is empty.
+         * @param builder builder
+         * @param input input, only read during the call
+         * @param executor executor parsing the chunks
+         * @return table block id, a DB_INGEST_TABLE
+         */
+        BlockId Ingest(DBFileBuilder& builder, std::string_view input, DBExecutor& executor = DefaultExecutor()) {
+            chunks.clear();
+            recordCount = 0;
+            bool csv = format == DBIF_CSV;
+            const char* begin = input.data();
+            const char* end = begin + input.size();
+            if (csv) {
+                begin = ParseCsvHeader(begin, end);
+            }
+
+            // split the input at the record boundaries
+            size_t count = std::max<size_t>(1, ((size_t)(end - begin) + chunkSize - 1) / chunkSize);
+            std::unique_ptr<uint8_t[]> quoted = std::make_unique<uint8_t[]>(count);
+            if (csv) {
+                executor.Run(count, [&quoted, begin, end, this](size_t i) {
+                    const char* b = begin + i * chunkSize;
+                    quoted[i] = utils::CountByte(b, std::min(end, b + chunkSize), '"') & 1;
+                });
+                // quoted[i] = the chunk i starts inside a quoted field
+                uint8_t parity = 0;
+                for (size_t i = 0; i < count; i++) {
+                    uint8_t p = quoted[i];
+                    quoted[i] = parity;
+                    parity ^= p;
+                }
+            }
+            chunks.resize(count);
+            executor.Run(count, [&quoted, begin, end, csv, this](size_t i) {
+                chunks[i].begin = i ? NextRecord(begin + i * chunkSize, end, csv, quoted[i]) : begin;
+            });
+            // a record bigger than a chunk leaves the next chunks empty
+            for (size_t i = 1; i < count; i++) {
+                chunks[i].begin = std::max(chunks[i].begin, chunks[i - 1].begin);
+                chunks[i - 1].end = chunks[i].begin;
+            }
+            chunks[count - 1].end = end;
+
+            executor.Run(count, [csv, this](size_t i) {
+                Chunk& chunk = chunks[i];
+                if (csv) {
+                    ParseCsv(chunk);
+                } else {
+                    ParseJsonLines(chunk);
+                }
+                // keep the next chunk strings aligned
+                chunk.strings.resize((chunk.strings.size() + sizeof(uint64_t) - 1) & ~(sizeof(uint64_t) - 1));
+            });
+
+            // the strings block starts with an empty string
+            uint64_t stringsSize = sizeof(uint64_t);
+            for (Chunk& chunk : chunks) {
+                chunk.stringsBase = stringsSize;
+                stringsSize += chunk.strings.size();
+                recordCount += chunk.count;
+            }
+            if (stringsSize > UINT32_MAX) {
+                DBFLIB_THROW("too many strings");
+            }
+            std::vector<uint32_t> stringColumns{};
+            for (const DBIngestSchema::Column& column : schema.Columns()) {
+                if (column.type == DBIT_STRING) {
+                    stringColumns.push_back(column.offset);
+                }
+            }
+            if (!stringColumns.empty()) {
+                executor.Run(count, [&stringColumns, this](size_t i) {
+                    Chunk& chunk = chunks[i];
+                    size_t recordSize = schema.RecordSize();
+                    for (size_t r = 0; r < chunk.count; r++) {
+                        for (uint32_t offset : stringColumns) {
+                            DB_INGEST_STRING* str = reinterpret_cast<DB_INGEST_STRING*>(chunk.records.data() + r * recordSize + offset);
+                            if (str->length) {
+                                str->offset += (uint32_t)chunk.stringsBase;
+                            }
+                        }
+                    }
+                });
+            }
+
+            const std::vector<DBIngestSchema::Column>& columns = schema.Columns();
+            auto [tableId, table] = builder.CreateBlock<DB_INGEST_TABLE>();
+            table->count = recordCount;
+            table->record_size = (uint32_t)schema.RecordSize();
+            table->column_count = (uint32_t)columns.size();
+            table->strings_size = stringsSize;
+
+            auto [columnsId, columnsBlock] = builder.CreateBlock<DB_INGEST_COLUMN>(columns.size() * sizeof(DB_INGEST_COLUMN));
+            for (size_t i = 0; i < columns.size(); i++) {
+                columnsBlock[i].type = columns[i].type;
+                columnsBlock[i].offset = columns[i].offset;
+            }
+            builder.CreateLink(tableId, offsetof(DB_INGEST_TABLE, columns), columnsId);
+            for (size_t i = 0; i < columns.size(); i++) {
+                BlockId nameId = builder.CreateBlock(columns[i].name.c_str(), columns[i].name.size() + 1);
+                builder.CreateLink(columnsId, (BlockOffset)(i * sizeof(DB_INGEST_COLUMN) + offsetof(DB_INGEST_COLUMN, name)), nameId);
+            }
+
+            // the chunks are contiguous, the sizes are multiples of 8
+            bool firstRecords = true;
+            for (const Chunk& chunk : chunks) {
+                BlockId id = builder.CreateBlockView(chunk.records.data(), chunk.records.size());
+                if (firstRecords && !chunk.records.empty()) {
+                    builder.CreateLink(tableId, offsetof(DB_INGEST_TABLE, records), id);
+                    firstRecords = false;
+                }
+            }
+            uint64_t empty{};
+            BlockId stringsId = builder.CreateBlock(&empty, sizeof(empty));
+            builder.CreateLink(tableId, offsetof(DB_INGEST_TABLE, strings), stringsId);
+            for (const Chunk& chunk : chunks) {
+                builder.CreateBlockView(chunk.strings.data(), chunk.strings.size());
+            }
+            return tableId;
+        }
+
+        /*
+         * Parse an input file and write the table into a file
+         * @param input input path
+         * @param output output path
+         * @param executor executor parsing the chunks
+         */
+        void IngestFile(const std::filesystem::path& input, const std::filesystem::path& output, DBExecutor& executor = DefaultExecutor()) {
+            DBFileBuilder builder{ DB_FILE_BUILDER_OPTIONS::DBFBO_ALIGN };
+#ifdef DBFLIB_POSIX
+            int fd = open(input.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                DBFLIB_THROW("can't open input file");
+            }
+            struct stat st {};
+            if (fstat(fd, &st)) {
+                close(fd);
+                DBFLIB_THROW("can't read input file");
+            }
+            size_t size = (size_t)st.st_size;
+            void* mapping = nullptr;
+            if (size) {
+                mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            }
+            close(fd);
+            if (mapping == MAP_FAILED) {
+                DBFLIB_THROW("can't map input file");
+            }
+            if (size) {
+                // the chunks are read in parallel, not sequentially
+                madvise(mapping, size, MADV_WILLNEED);
+            }
+            auto unmap = [size](void* ptr) {
+                if (ptr) {
+                    munmap(ptr, size);
+                }
+            };
+            std::unique_ptr<void, decltype(unmap)> guard{ mapping, unmap };
+            Ingest(builder, std::string_view{ reinterpret_cast<const char*>(mapping), size }, executor);
+            guard.reset();
+#else
+            std::ifstream is{ input, std::ios::binary };
+            if (!is) {
+                DBFLIB_THROW("can't open input file");
+            }
+            std::string data{ std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>() };
+            Ingest(builder, data, executor);
+#endif
+            builder.WriteToFile(output);
+        }
+
+        /*
+         * @return record count of the last ingestion
+         */
+        uint64_t RecordCount() const {
+            return recordCount;
+        }
+    };
+}
@@ -0,0 +1,400 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+/*
+ * Bit packed integer array blocks
+ */
+namespace dbflib {
+    // values per packed block
+    constexpr size_t DB_PACKED_ARRAY_BLOCK = 128;
+
+    enum DB_PACKED_ENCODING : uint8_t {
+        // frame of reference, each block stores value - block minimum
+        DBPE_FOR = 0,
+        // delta, each block stores value - previous value, fits best for sorted values
+        DBPE_DELTA = 1,
+    };
+
+    /*
+     * Packed block description, the values are bit packed in the array data at offset, if the block
+     * has exceptions, the values are followed by a 128 bits bitmap of the exception indexes and by
+     * the high bits of each exception.
+     */
+    template<typename ValueType>
+    struct DB_PACKED_ARRAY_BLOCK_HEADER {
+        ValueType base{};
+        uint32_t offset{};
+        uint8_t width{};
+        uint8_t exceptions{};
+        uint16_t __pad{};
+    };
+
+    template<typename ValueType>
+    struct DB_PACKED_ARRAY {
+        static_assert(std::is_same_v<ValueType, uint32_t> || std::is_same_v<ValueType, uint64_t>, "packed arrays only support uint32_t or uint64_t");
+
+        uint64_t count{};
+        uint8_t encoding{};
+        uint8_t __pad[7]{};
+        DB_PACKED_ARRAY_BLOCK_HEADER<ValueType>* blocks{};
+        uint8_t* data{};
+
+        /*
+         * @return value count
+         */
+        constexpr size_t Size() const {
+            return (size_t)count;
+        }
+
+        /*
+         * Get a value, O(1) for DBPE_FOR, O(DB_PACKED_ARRAY_BLOCK) for DBPE_DELTA
+         * @param index value index
+         * @return value
+         */
+        ValueType operator[](size_t index) const {
+            const DB_PACKED_ARRAY_BLOCK_HEADER<ValueType>& block = blocks[index / DB_PACKED_ARRAY_BLOCK];
+            size_t i = index % DB_PACKED_ARRAY_BLOCK;
+            if (encoding == DBPE_DELTA) {
+                ValueType v = block.base;
+                for (size_t j = 1; j <= i; j++) {
+                    v += Value(block, j);
+                }
+                return v;
+            }
+            return block.base + Value(block, i);
+        }
+
+        /*
+         * Decode a packed block
+         * @param blockIndex block index
+         * @param out output, should contain at least DB_PACKED_ARRAY_BLOCK values
+         * @return decoded values count
+         */
+        size_t DecodeBlock(size_t blockIndex, ValueType* out) const {
+            const DB_PACKED_ARRAY_BLOCK_HEADER<ValueType>& block = blocks[blockIndex];
+            size_t len = std::min<size_t>(DB_PACKED_ARRAY_BLOCK, (size_t)count - blockIndex * DB_PACKED_ARRAY_BLOCK);
+            const uint8_t* packed = data + block.offset;
+
+            size_t i = 0;
+            if (block.width == 0) {
+                std::memset(out, 0, len * sizeof(ValueType));
+                i = len;
+            }
+#ifdef DBFLIB_AVX2
+            else if constexpr (std::is_same_v<ValueType, uint32_t>) {
+                if (block.width <= 25) {
+                    // 8 values per gather, a 32 bits load contains the value and its bit shift
+                    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+                    const __m256i width = _mm256_set1_epi32(block.width);
+                    const __m256i mask = _mm256_set1_epi32((int)((1u << block.width) - 1));
+                    const __m256i seven = _mm256_set1_epi32(7);
+                    for (; i + 8 <= len; i += 8) {
+                        __m256i bit = _mm256_mullo_epi32(_mm256_add_epi32(lanes, _mm256_set1_epi32((int)i)), width);
+                        __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int*>(packed), _mm256_srli_epi32(bit, 3), 1);
+                        v = _mm256_and_si256(_mm256_srlv_epi32(v, _mm256_and_si256(bit, seven)), mask);
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+                    }
+                }
+            } else {
+                if (block.width <= 56) {
+                    // 4 values per gather
+                    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+                    const __m128i width = _mm_set1_epi32(block.width);
+                    const __m256i mask = _mm256_set1_epi64x((long long)((1ull << block.width) - 1));
+                    const __m128i seven = _mm_set1_epi32(7);
+                    for (; i + 4 <= len; i += 4) {
+                        __m128i bit = _mm_mullo_epi32(_mm_add_epi32(lanes, _mm_set1_epi32((int)i)), width);
+                        __m256i v = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(packed), _mm_srli_epi32(bit, 3), 1);
+                        v = _mm256_srlv_epi64(v, _mm256_cvtepu32_epi64(_mm_and_si128(bit, seven)));
+                        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _mm256_and_si256(v, mask));
+                    }
+                }
+            }
+#elif defined(DBFLIB_SSE2)
+            else if constexpr (std::is_same_v<ValueType, uint32_t>) {
+                if (block.width <= 25) {
+                    // 8 values are packed in width bytes, a lane decodes a group of 8 values, so the 4 lanes use the
+                    // same bit shifts, the values are then transposed
+                    const size_t width = block.width;
+                    const __m128i mask = _mm_set1_epi32((int)((1u << width) - 1));
+                    for (; i + 32 <= len; i += 32) {
+                        const uint8_t* group = packed + i / 8 * width;
+                        __m128i v[8];
+                        for (size_t j = 0; j < 8; j++) {
+                            size_t bit = j * width;
+                            const uint8_t* p = group + (bit >> 3);
+                            uint32_t l[4];
+                            for (size_t k = 0; k < 4; k++) {
+                                std::memcpy(&l[k], p + k * width, sizeof(l[k]));
+                            }
+                            __m128i loaded = _mm_setr_epi32((int)l[0], (int)l[1], (int)l[2], (int)l[3]);
+                            v[j] = _mm_and_si128(_mm_srl_epi32(loaded, _mm_cvtsi32_si128((int)(bit & 7))), mask);
+                        }
+                        for (size_t j = 0; j < 8; j += 4) {
+                            __m128i t0 = _mm_unpacklo_epi32(v[j], v[j + 1]);
+                            __m128i t1 = _mm_unpacklo_epi32(v[j + 2], v[j + 3]);
+                            __m128i t2 = _mm_unpackhi_epi32(v[j], v[j + 1]);
+                            __m128i t3 = _mm_unpackhi_epi32(v[j + 2], v[j + 3]);
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + j), _mm_unpacklo_epi64(t0, t1));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8 + j), _mm_unpackhi_epi64(t0, t1));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 16 + j), _mm_unpacklo_epi64(t2, t3));
+                            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 24 + j), _mm_unpackhi_epi64(t2, t3));
+                        }
+                    }
+                }
+            } else {
+                if (block.width <= 56) {
+                    // same with 2 lanes of 64 bits
+                    const size_t width = block.width;
+                    const __m128i mask = _mm_set1_epi64x((long long)((1ull << width) - 1));
+                    for (; i + 16 <= len; i += 16) {
+                        const uint8_t* group = packed + i / 8 * width;
+                        __m128i v[2];
+                        for (size_t j = 0; j < 8; j++) {
+                            size_t bit = j * width;
+                            const uint8_t* p = group + (bit >> 3);
+                            uint64_t l0, l1;
+                            std::memcpy(&l0, p, sizeof(l0));
+                            std::memcpy(&l1, p + width, sizeof(l1));
+                            __m128i loaded = _mm_set_epi64x((long long)l1, (long long)l0);
+                            v[j & 1] = _mm_and_si128(_mm_srl_epi64(loaded, _mm_cvtsi32_si128((int)(bit & 7))), mask);
+                            if (j & 1) {
+                                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + j - 1), _mm_unpacklo_epi64(v[0], v[1]));
+                                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 8 + j - 1), _mm_unpackhi_epi64(v[0], v[1]));
+                            }
+                        }
+                    }
+                }
+            }
+#endif
+            for (; i < len; i++) {
+                out[i] = Extract(packed, i, block.width);
+            }
+
+            if (block.exceptions) {
+                uint64_t bitmap[2];
+                const uint8_t* exceptions = ExceptionsData(block);
+                std::memcpy(bitmap, exceptions, sizeof(bitmap));
+                const uint8_t* highs = exceptions + sizeof(bitmap);
+                size_t e = 0;
+                for (size_t w = 0; w < 2; w++) {
+                    for (uint64_t b = bitmap[w]; b; b &= b - 1) {
+                        ValueType high;
+                        std::memcpy(&high, highs + e++ * sizeof(ValueType), sizeof(high));
+                        out[w * 64 + std::countr_zero(b)] |= high << block.width;
+                    }
+                }
+            }
+
+            if (encoding == DBPE_DELTA) {
+                ValueType v = block.base;
+                out[0] = v;
+                for (i = 1; i < len; i++) {
+                    v += out[i];
+                    out[i] = v;
+                }
+            } else {
+                for (i = 0; i < len; i++) {
+                    out[i] += block.base;
+                }
+            }
+            return len;
+        }
+
+        /*
+         * Decode a range of values
+         * @param start first value index
+         * @param len value count
+         * @param out output, should contain at least len values
+         */
+        void Decode(size_t start, size_t len, ValueType* out) const {
+            ValueType buffer[DB_PACKED_ARRAY_BLOCK];
+            size_t end = start + len;
+            while (start < end) {
+                size_t blockIndex = start / DB_PACKED_ARRAY_BLOCK;
+                size_t first = start % DB_PACKED_ARRAY_BLOCK;
+                size_t available = std::min(DB_PACKED_ARRAY_BLOCK - first, end - start);
+                if (!first && available == DB_PACKED_ARRAY_BLOCK) {
+                    DecodeBlock(blockIndex, out);
+                } else {
+                    DecodeBlock(blockIndex, buffer);
+                    std::memcpy(out, buffer + first, available * sizeof(ValueType));
+                }
+                out += available;
+                start += available;
+            }
+        }
+
+        /*
+         * Decode all the values in order
+         * @param func callback (ValueType value, size_t index)
+         */
+        template<typename Func>
+        void ForEach(Func&& func) const {
+            ValueType buffer[DB_PACKED_ARRAY_BLOCK];
+            for (size_t b = 0; b * DB_PACKED_ARRAY_BLOCK < count; b++) {
+                size_t len = DecodeBlock(b, buffer);
+                for (size_t i = 0; i < len; i++) {
+                    func(buffer[i], b * DB_PACKED_ARRAY_BLOCK + i);
+                }
+            }
+        }
+
+    private:
+        static ValueType Extract(const uint8_t* packed, size_t i, uint8_t width) {
+            if (!width) {
+                return 0;
+            }
+            size_t bit = i * width;
+            size_t shift = bit & 7;
+            uint64_t v;
+            std::memcpy(&v, packed + (bit >> 3), sizeof(v));
+            v >>= shift;
+            if (width + shift > 64) {
+                v |= (uint64_t)packed[(bit >> 3) + 8] << (64 - shift);
+            }
+            if (width < 64) {
+                v &= (1ull << width) - 1;
+            }
+            return (ValueType)v;
+        }
+
+        const uint8_t* ExceptionsData(const DB_PACKED_ARRAY_BLOCK_HEADER<ValueType>& block) const {
+            return data + block.offset + (DB_PACKED_ARRAY_BLOCK * block.width + 7) / 8;
+        }
+
+        ValueType Value(const DB_PACKED_ARRAY_BLOCK_HEADER<ValueType>& block, size_t i) const {
+            ValueType v = Extract(data + block.offset, i, block.width);
+            if (block.exceptions) {
+                uint64_t bitmap[2];
+                const uint8_t* exceptions = ExceptionsData(block);
+                std::memcpy(bitmap, exceptions, sizeof(bitmap));
+                if ((bitmap[i >> 6] >> (i & 63)) & 1) {
+                    size_t rank = std::popcount(bitmap[i >> 6] & ((1ull << (i & 63)) - 1));
+                    if (i >= 64) {
+                        rank += std::popcount(bitmap[0]);
+                    }
+                    ValueType high;
+                    std::memcpy(&high, exceptions + sizeof(bitmap) + rank * sizeof(ValueType), sizeof(high));
+                    v |= high << block.width;
+                }
+            }
+            return v;
+        }
+    };
+
+    /*
+     * Create a packed integer array, each block of DB_PACKED_ARRAY_BLOCK values is using the bit width
+     * minimizing its size, the values larger than this width are stored as exceptions (patched frame of reference).
+     * @param ValueType uint32_t or uint64_t
+     * @param builder builder
+     * @param values values
+     * @param encoding encoding, described in DB_PACKED_ENCODING
+     * @return block id of the DB_PACKED_ARRAY
+     */
+    template<typename ValueType>
+    BlockId CreatePackedArray(DBFileBuilder& builder, std::span<const ValueType> values, DB_PACKED_ENCODING encoding = DBPE_FOR) {
+        constexpr size_t bits = sizeof(ValueType) * 8;
+        std::vector<DB_PACKED_ARRAY_BLOCK_HEADER<ValueType>> headers{};
+        std::vector<uint8_t> data{};
+        ValueType encoded[DB_PACKED_ARRAY_BLOCK];
+
+        headers.reserve((values.size() + DB_PACKED_ARRAY_BLOCK - 1) / DB_PACKED_ARRAY_BLOCK);
+        for (size_t start = 0; start < values.size(); start += DB_PACKED_ARRAY_BLOCK) {
+            size_t len = std::min(DB_PACKED_ARRAY_BLOCK, values.size() - start);
+            const ValueType* block = values.data() + start;
+            DB_PACKED_ARRAY_BLOCK_HEADER<ValueType>& header = headers.emplace_back();
+
+            if (encoding == DBPE_DELTA) {
+                header.base = block[0];
+                encoded[0] = 0;
+                for (size_t i = 1; i < len; i++) {
+                    encoded[i] = block[i] - block[i - 1];
+                }
+            } else {
+                header.base = *std::min_element(block, block + len);
+                for (size_t i = 0; i < len; i++) {
+                    encoded[i] = block[i] - header.base;
+                }
+            }
+
+            // bit length histogram to find the cheapest width
+            size_t widths[bits + 1]{};
+            for (size_t i = 0; i < len; i++) {
+                widths[std::bit_width(encoded[i])]++;
+            }
+            size_t width = bits;
+            size_t bestCost = SIZE_MAX;
+            size_t above = 0;
+            for (size_t w = bits + 1; w-- > 0;) {
+                size_t cost = DB_PACKED_ARRAY_BLOCK * w + (above ? above * bits + DB_PACKED_ARRAY_BLOCK : 0);
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    width = w;
+                }
+                above += widths[w];
+            }
+
+            header.offset = (uint32_t)data.size();
+            header.width = (uint8_t)width;
+
+            size_t packedSize = (DB_PACKED_ARRAY_BLOCK * width + 7) / 8;
+            // padding for the unaligned writes
+            data.resize(data.size() + packedSize + 16);
+            uint8_t* packed = data.data() + header.offset;
+            uint64_t bitmap[2]{};
+            std::vector<ValueType> highs{};
+            for (size_t i = 0; i < len; i++) {
+                ValueType v = encoded[i];
+                if (width < bits && (v >> width)) {
+                    bitmap[i >> 6] |= 1ull << (i & 63);
+                    highs.push_back(v >> width);
+                    v &= ((ValueType)1 << width) - 1;
+                }
+                if (width) {
+                    size_t bit = i * width;
+                    size_t shift = bit & 7;
+                    uint64_t cur;
+                    std::memcpy(&cur, packed + (bit >> 3), sizeof(cur));
+                    cur |= (uint64_t)v << shift;
+                    std::memcpy(packed + (bit >> 3), &cur, sizeof(cur));
+                    if (width + shift > 64) {
+                        packed[(bit >> 3) + 8] |= (uint8_t)((uint64_t)v >> (64 - shift));
+                    }
+                }
+            }
+            data.resize(header.offset + packedSize);
+            if (!highs.empty()) {
+                header.exceptions = (uint8_t)highs.size();
+                data.insert(data.end(), reinterpret_cast<uint8_t*>(bitmap), reinterpret_cast<uint8_t*>(bitmap) + sizeof(bitmap));
+                data.insert(data.end(), reinterpret_cast<uint8_t*>(highs.data()), reinterpret_cast<uint8_t*>(highs.data() + highs.size()));
+            }
+            if (data.size() > INT32_MAX) {
+                DBFLIB_THROW("file too big");
+            }
+        }
+        // padding for the unaligned reads
+        data.resize(data.size() + 16);
+        // keep a valid pointer for the empty arrays
+        headers.emplace_back();
+
+        builder.AlignBlock();
+        auto [arrayId, array] = builder.CreateBlock<DB_PACKED_ARRAY<ValueType>>();
+        array->count = values.size();
+        array->encoding = encoding;
+
+        builder.AlignBlock();
+        BlockId headersId = builder.CreateBlock(headers.data(), headers.size() * sizeof(headers[0]));
+        BlockId dataId = builder.CreateBlock(data.data(), data.size());
+        builder.CreateLink(arrayId, offsetof(DB_PACKED_ARRAY<ValueType>, blocks), headersId);
+        builder.CreateLink(arrayId, offsetof(DB_PACKED_ARRAY<ValueType>, data), dataId);
+
+        return arrayId;
+    }
+}
@@ -0,0 +1,219 @@
+#pragma once
+#include "dbflib.hpp"
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+
+/*
+ * Progressive file loader
+ */
+namespace dbflib {
+    /*
+     * Link the sections of a file on background threads, the sections with the higher priority first. A file without
+     * sections is loaded as one section. The caller can access a section once it is ready, a section accessed before
+     * being linked by the background threads is linked by the caller.
+     */
+    class DBProgressiveLoader {
+        enum SectionState : uint32_t {
+            DBPLS_PENDING = 0,
+            DBPLS_LINKING,
+            DBPLS_READY,
+        };
+
+        struct Section {
+            DB_FILE_SECTION section{};
+            std::atomic<uint32_t> state{};
+            std::promise<void> promise{};
+            std::shared_future<void> ready{};
+        };
+
+        DB_FILE* file;
+        std::unique_ptr<Section[]> sections{};
+        size_t sectionCount{};
+        // sections by priority
+        std::vector<size_t> order{};
+        std::atomic<size_t> next{};
+        std::atomic<size_t> remaining{};
+        std::atomic<bool> stop{};
+        std::vector<std::thread> threads{};
+
+        // link a section if it isn't claimed by another thread
+        bool TryLink(size_t id) {
+            Section& s = sections[id];
+            uint32_t expected = DBPLS_PENDING;
+            if (!s.state.compare_exchange_strong(expected, DBPLS_LINKING, std::memory_order_acquire)) {
+                return false;
+            }
+#ifdef __cpp_exceptions
+            try {
+                file->LinkRange(s.section.first_link, (size_t)s.section.first_link + s.section.links_count);
+                s.state.store(DBPLS_READY, std::memory_order_release);
+                s.promise.set_value();
+            } catch (...) {
+                s.state.store(DBPLS_READY, std::memory_order_release);
+                s.promise.set_exception(std::current_exception());
+            }
+#else
+            file->LinkRange(s.section.first_link, (size_t)s.section.first_link + s.section.links_count);
+            s.state.store(DBPLS_READY, std::memory_order_release);
+            s.promise.set_value();
+#endif
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 && file->version >= DB_FILE_VERSION_FEATURE::FAST_LINKING) {
+                file->last_link = (void*)file;
+            }
+            return true;
+        }
+
+        void Worker() {
+            size_t i;
+            while (!stop.load(std::memory_order_relaxed) && (i = next.fetch_add(1, std::memory_order_relaxed)) < order.size()) {
+                TryLink(order[i]);
+            }
+        }
+    public:
+        /*
+         * Validate the file and start linking it
+         * @param file file
+         * @param length file size, 0 for unknown
+         * @param threadCount background thread count
+         */
+        DBProgressiveLoader(DB_FILE* file, size_t length = 0, size_t threadCount = 1) : file(file) {
+            file->Validate(length);
+
+            size_t extensionSize{};
+            const DB_FILE_SECTION* fileSections = file->GetExtension<const DB_FILE_SECTION>(DBFE_SECTIONS, &extensionSize);
+            if (fileSections) {
+                sectionCount = extensionSize / sizeof(DB_FILE_SECTION);
+            }
+            if (!sectionCount) {
+                sectionCount = 1;
+            }
+            sections = std::make_unique<Section[]>(sectionCount);
+            for (size_t i = 0; i < sectionCount; i++) {
+                Section& s = sections[i];
+                if (fileSections) {
+                    s.section = fileSections[i];
+                    if ((size_t)s.section.first_link + s.section.links_count > file->links_count) {
+                        DBFLIB_THROW("invalid file: section links after the links table");
+                    }
+                    if (i > 1 && s.section.begin < fileSections[i - 1].end) {
+                        DBFLIB_THROW("invalid file: sections not sorted");
+                    }
+                } else {
+                    s.section.links_count = file->version >= DB_FILE_VERSION_FEATURE::LINKING ? file->links_count : 0;
+                }
+                s.ready = s.promise.get_future().share();
+                order.push_back(i);
+            }
+            std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+                return sections[a].section.priority > sections[b].section.priority;
+            });
+            remaining.store(sectionCount, std::memory_order_relaxed);
+
+            for (size_t i = 0; i < std::max<size_t>(1, threadCount); i++) {
+                threads.emplace_back(&DBProgressiveLoader::Worker, this);
+            }
+        }
+
+        DBProgressiveLoader(DBProgressiveLoader& o) = delete;
+        DBProgressiveLoader(DBProgressiveLoader&& o) = delete;
+
+        ~DBProgressiveLoader() {
+            stop.store(true, std::memory_order_relaxed);
+            for (std::thread& t : threads) {
+                t.join();
+            }
+        }
+
+        /*
+         * @return section count, the section 0 contains the blocks outside of the builder sections
+         */
+        size_t SectionCount() const {
+            return sectionCount;
+        }
+
+        /*
+         * Find the section containing a pointer of the file
+         * @param ptr pointer
+         * @return section id
+         */
+        size_t FindSection(const void* ptr) const {
+            size_t offset = (size_t)(reinterpret_cast<const uint8_t*>(ptr) - file->magic);
+            // the builder sections are sorted by offset
+            const Section* begin = sections.get() + 1;
+            const Section* end = sections.get() + sectionCount;
+            const Section* it = std::upper_bound(begin, end, offset, [](size_t o, const Section& s) { return o < s.section.begin; });
+            if (it == begin || offset >= (it - 1)->section.end) {
+                return 0;
+            }
+            return (size_t)(it - sections.get()) - 1;
+        }
+
+        /*
+         * Test if a section is linked
+         * @param id section id
+         * @return true if the section is linked
+         */
+        bool IsReady(size_t id) const {
+            return sections[id].state.load(std::memory_order_acquire) == DBPLS_READY;
+        }
+
+        /*
+         * Get the readiness future of a section
+         * @param id section id
+         * @return future, set once the section is linked
+         */
+        std::shared_future<void> Ready(size_t id) const {
+            return sections[id].ready;
+        }
+
+        /*
+         * Wait for a section to be linked, the section is linked by the caller if it isn't started
+         * @param id section id
+         */
+        void Wait(size_t id) {
+            if (!IsReady(id)) {
+                TryLink(id);
+            }
+            sections[id].ready.get();
+        }
+
+        /*
+         * Wait for all the sections to be linked
+         */
+        void WaitAll() {
+            for (size_t i = 0; i < sectionCount; i++) {
+                Wait(i);
+            }
+        }
+
+        /*
+         * Access a pointer of the file, wait for its section to be linked
+         * @param ptr pointer
+         * @return ptr
+         */
+        template<typename Type>
+        Type* Access(Type* ptr) {
+            Wait(FindSection(ptr));
+            return ptr;
+        }
+
+        /*
+         * Access the start of the file, wait for its section to be linked
+         * @param StartType return type
+         * @return start
+         */
+        template<typename StartType = void>
+        StartType* GetStart() {
+            return Access(file->Start<StartType>());
+        }
+
+        /*
+         * @return file
+         */
+        constexpr DB_FILE* GetFile() {
+            return file;
+        }
+    };
+}
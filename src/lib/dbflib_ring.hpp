@@ -0,0 +1,484 @@
+#pragma once
+#include "dbflib.hpp"
+#include <atomic>
+#include <new>
+#include <string>
+#include <thread>
+
+/*
+ * Shared memory message ring, the messages are built in place by the producers and read without copy or linking by
+ * the consumer, the pointers inside a message are self-relative (DBRelPtr)
+ */
+namespace dbflib {
+    /*
+     * Pointer relative to its own address, valid in any mapping of the memory containing both the pointer and the
+     * pointed data. It can't be copied, a pointer of another message is set with ptr = other.Get(). The null pointer
+     * is the zeroed memory of DBRingMessageBuilder::Allocate.
+     * @param Type pointed type
+     */
+    template<typename Type>
+    class DBRelPtr {
+        // offset from this, 0 for null
+        int64_t offset;
+    public:
+        DBRelPtr() = default;
+        DBRelPtr(const DBRelPtr& o) = delete;
+        DBRelPtr& operator=(const DBRelPtr& o) = delete;
+
+        DBRelPtr& operator=(Type* ptr) {
+            Set(ptr);
+            return *this;
+        }
+
+        /*
+         * Set the pointed data
+         * @param ptr pointer in the same memory as this, can be null
+         */
+        void Set(Type* ptr) {
+            offset = ptr ? reinterpret_cast<const uint8_t*>(ptr) - reinterpret_cast<const uint8_t*>(this) : 0;
+        }
+
+        /*
+         * @return pointed data, null if not set
+         */
+        Type* Get() const {
+            return offset ? reinterpret_cast<Type*>(const_cast<uint8_t*>(reinterpret_cast<const uint8_t*>(this)) + offset) : nullptr;
+        }
+
+        Type* operator->() const {
+            return Get();
+        }
+
+        Type& operator*() const {
+            return *Get();
+        }
+
+        Type& operator[](size_t index) const {
+            return Get()[index];
+        }
+
+        explicit operator bool() const {
+            return offset != 0;
+        }
+    };
+
+#ifdef DBFLIB_POSIX
+    // "$DBFRING"
+    constexpr uint64_t DB_RING_MAGIC = 0x474e495246424424;
+    // alignment of the message data
+    constexpr size_t DB_RING_DATA_ALIGNMENT = 16;
+
+    static_assert(std::atomic<uint64_t>::is_always_lock_free && "The shared ring requires lock free 64 bits atomics");
+
+    enum DB_RING_FLAGS : uint32_t {
+        // allow multiple concurrent producers, the reservations use a CAS instead of a store
+        DBRF_MULTI_PRODUCER = 1,
+    };
+
+    /*
+     * Ring header, at the start of the shared memory, followed by the slots
+     */
+    struct DB_RING_HEADER {
+        uint64_t magic;
+        uint32_t slot_count;
+        uint32_t slot_size;
+        uint32_t flags;
+        uint32_t __pad;
+        uint64_t size;
+        // next position to reserve
+        alignas(64) std::atomic<uint64_t> tail;
+        // next position to read, only used by the consumer
+        alignas(64) std::atomic<uint64_t> head;
+    };
+
+    /*
+     * Slot header, followed by slot_size bytes of message data
+     */
+    struct DB_RING_SLOT {
+        // position + 1 when a message is committed, position + slot_count when the slot is free again
+        std::atomic<uint64_t> sequence;
+        uint32_t size;
+        uint32_t type;
+    };
+
+    static_assert(sizeof(DB_RING_SLOT) % DB_RING_DATA_ALIGNMENT == 0);
+
+    /*
+     * Message reserved by a producer or read by the consumer
+     */
+    struct DB_RING_MESSAGE {
+        DB_RING_SLOT* slot{};
+        uint64_t position{};
+        // message data, aligned on DB_RING_DATA_ALIGNMENT
+        uint8_t* data{};
+        // data size, the capacity of the slot for a reserved message
+        uint32_t size{};
+        // user message type
+        uint32_t type{};
+
+        /*
+         * @param RootType root type
+         * @return message root, at the start of the data
+         */
+        template<typename RootType>
+        RootType* Root() const {
+            return reinterpret_cast<RootType*>(data);
+        }
+    };
+
+    /*
+     * Build a message in place in a reserved slot, the objects are allocated in order from the start of the slot and
+     * should be linked with DBRelPtr, the first allocation is the root
+     */
+    class DBRingMessageBuilder {
+        DB_RING_MESSAGE& message;
+        size_t used{};
+    public:
+        /*
+         * @param message reserved message
+         */
+        DBRingMessageBuilder(DB_RING_MESSAGE& message) : message(message) {}
+
+        /*
+         * Allocate zeroed objects in the message
+         * @param Type object type, implicit lifetime type (trivial default constructor and destructor)
+         * @param count objects count
+         * @return objects
+         */
+        template<typename Type>
+        Type* Allocate(size_t count = 1) {
+            static_assert(alignof(Type) <= DB_RING_DATA_ALIGNMENT && "Type alignment too big for a ring message");
+            size_t offset = (used + alignof(Type) - 1) & ~(alignof(Type) - 1);
+            if (offset + sizeof(Type) * count > message.size) {
+                DBFLIB_THROW("message too big for the ring slot");
+            }
+            used = offset + sizeof(Type) * count;
+            std::memset(message.data + offset, 0, sizeof(Type) * count);
+            return reinterpret_cast<Type*>(message.data + offset);
+        }
+
+        /*
+         * Copy a string in the message, null terminated
+         * @param str string
+         * @return copied string
+         */
+        const char* AllocateString(std::string_view str) {
+            char* out = Allocate<char>(str.size() + 1);
+            std::memcpy(out, str.data(), str.size());
+            return out;
+        }
+
+        /*
+         * @return used size of the message
+         */
+        constexpr size_t Size() const {
+            return used;
+        }
+    };
+
+    /*
+     * Bounded lock free message ring in shared memory (Vyukov queue) with one consumer and one or multiple producers.
+     * The producer reserves a slot, builds the message in place and commits it, the consumer reads the message in the
+     * slot and releases it, so the messages are never copied.
+     */
+    class DBSharedRing {
+        uint8_t* mapping{};
+        size_t mappingSize{};
+        size_t stride{};
+        uint64_t mask{};
+        bool multiProducer{};
+
+        static size_t Stride(size_t slotSize) {
+            return (sizeof(DB_RING_SLOT) + slotSize + 63) & ~(size_t)63;
+        }
+
+        static size_t MappingSize(size_t slotCount, size_t slotSize) {
+            return sizeof(DB_RING_HEADER) + slotCount * Stride(slotSize);
+        }
+
+        DB_RING_HEADER* Header() const {
+            return reinterpret_cast<DB_RING_HEADER*>(mapping);
+        }
+
+        DB_RING_SLOT* Slot(uint64_t position) const {
+            return reinterpret_cast<DB_RING_SLOT*>(mapping + sizeof(DB_RING_HEADER) + (position & mask) * stride);
+        }
+
+        static void CheckSizes(size_t slotCount, size_t slotSize) {
+            if (slotCount < 2 || (slotCount & (slotCount - 1)) || slotCount > UINT32_MAX) {
+                DBFLIB_THROW("the ring slot count should be a power of 2");
+            }
+            if (!slotSize || slotSize > UINT32_MAX) {
+                DBFLIB_THROW("invalid ring slot size");
+            }
+        }
+
+        void Map(int fd, size_t size) {
+            void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | (fd < 0 ? MAP_ANONYMOUS : 0), fd, 0);
+            if (ptr == MAP_FAILED) {
+                DBFLIB_THROW("can't map the ring");
+            }
+            mapping = reinterpret_cast<uint8_t*>(ptr);
+            mappingSize = size;
+        }
+
+        void Init(size_t slotCount, size_t slotSize, uint32_t flags) {
+            DB_RING_HEADER* header = new (mapping) DB_RING_HEADER{};
+            header->slot_count = (uint32_t)slotCount;
+            header->slot_size = (uint32_t)slotSize;
+            header->flags = flags;
+            header->size = mappingSize;
+            Attach();
+            for (size_t i = 0; i < slotCount; i++) {
+                new (Slot(i)) DB_RING_SLOT{ i, 0, 0 };
+            }
+            std::atomic_ref<uint64_t>(header->magic).store(DB_RING_MAGIC, std::memory_order_release);
+        }
+
+        void Attach() {
+            const DB_RING_HEADER* header = Header();
+            stride = Stride(header->slot_size);
+            mask = header->slot_count - 1;
+            multiProducer = header->flags & DBRF_MULTI_PRODUCER;
+        }
+
+        static bool ValidHeader(const DB_RING_HEADER& header, size_t size) {
+            return header.slot_count >= 2 && !(header.slot_count & (header.slot_count - 1)) && header.slot_size
+                && header.size == size && MappingSize(header.slot_count, header.slot_size) <= size;
+        }
+
+        void Release() {
+            if (mapping) {
+                munmap(mapping, mappingSize);
+                mapping = nullptr;
+            }
+        }
+    public:
+        /*
+         * Create an anonymous ring, shared with the processes forked after its creation
+         * @param slotCount slots count, power of 2
+         * @param slotSize max message size
+         * @param flags ring flags, described in DB_RING_FLAGS
+         */
+        DBSharedRing(size_t slotCount, size_t slotSize, uint32_t flags = 0) {
+            CheckSizes(slotCount, slotSize);
+            Map(-1, MappingSize(slotCount, slotSize));
+            Init(slotCount, slotSize, flags);
+        }
+
+        /*
+         * Create a named ring with shm_open, fails if the name already exists
+         * @param name shared memory name, starting with '/'
+         * @param slotCount slots count, power of 2
+         * @param slotSize max message size
+         * @param flags ring flags, described in DB_RING_FLAGS
+         */
+        DBSharedRing(const std::string& name, size_t slotCount, size_t slotSize, uint32_t flags = 0) {
+            CheckSizes(slotCount, slotSize);
+            int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+            if (fd < 0) {
+                DBFLIB_THROW("can't create the shared memory");
+            }
+            size_t size = MappingSize(slotCount, slotSize);
+            if (ftruncate(fd, (off_t)size)) {
+                close(fd);
+                shm_unlink(name.c_str());
+                DBFLIB_THROW("can't resize the shared memory");
+            }
+#ifdef __cpp_exceptions
+            try {
+#endif
+                Map(fd, size);
+#ifdef __cpp_exceptions
+            } catch (...) {
+                close(fd);
+                shm_unlink(name.c_str());
+                throw;
+            }
+#endif
+            close(fd);
+            Init(slotCount, slotSize, flags);
+        }
+
+        /*
+         * Open a named ring created by another process
+         * @param name shared memory name
+         */
+        DBSharedRing(const std::string& name) {
+            int fd = shm_open(name.c_str(), O_RDWR, 0);
+            if (fd < 0) {
+                DBFLIB_THROW("can't open the shared memory");
+            }
+            struct stat st;
+            if (fstat(fd, &st) || (size_t)st.st_size < sizeof(DB_RING_HEADER)) {
+                close(fd);
+                DBFLIB_THROW("invalid ring: shared memory too small");
+            }
+#ifdef __cpp_exceptions
+            try {
+#endif
+                Map(fd, (size_t)st.st_size);
+#ifdef __cpp_exceptions
+            } catch (...) {
+                close(fd);
+                throw;
+            }
+#endif
+            close(fd);
+            DB_RING_HEADER* header = Header();
+            if (std::atomic_ref<uint64_t>(header->magic).load(std::memory_order_acquire) != DB_RING_MAGIC
+                || !ValidHeader(*header, mappingSize)) {
+                Release();
+                DBFLIB_THROW("invalid ring");
+            }
+            Attach();
+        }
+
+        DBSharedRing(DBSharedRing& o) = delete;
+        DBSharedRing(DBSharedRing&& o) noexcept
+            : mapping(o.mapping), mappingSize(o.mappingSize), stride(o.stride), mask(o.mask), multiProducer(o.multiProducer) {
+            o.mapping = nullptr;
+        }
+
+        ~DBSharedRing() {
+            Release();
+        }
+
+        /*
+         * Remove a named ring, the mapped rings stay valid
+         * @param name shared memory name
+         */
+        static void Unlink(const std::string& name) {
+            shm_unlink(name.c_str());
+        }
+
+        /*
+         * @return slots count
+         */
+        uint32_t SlotCount() const {
+            return Header()->slot_count;
+        }
+
+        /*
+         * @return max message size
+         */
+        uint32_t SlotSize() const {
+            return Header()->slot_size;
+        }
+
+        /*
+         * Reserve a slot without waiting
+         * @param message output message, the size is the capacity of the slot
+         * @return false if the ring is full
+         */
+        bool TryReserve(DB_RING_MESSAGE& message) {
+            DB_RING_HEADER* header = Header();
+            uint64_t position = header->tail.load(std::memory_order_relaxed);
+            while (true) {
+                DB_RING_SLOT* slot = Slot(position);
+                int64_t diff = (int64_t)(slot->sequence.load(std::memory_order_acquire) - position);
+                if (diff < 0) {
+                    // not released by the consumer
+                    return false;
+                }
+                if (diff > 0) {
+                    // reserved by another producer
+                    position = header->tail.load(std::memory_order_relaxed);
+                    continue;
+                }
+                if (multiProducer) {
+                    if (!header->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        continue;
+                    }
+                } else {
+                    header->tail.store(position + 1, std::memory_order_relaxed);
+                }
+                message = DB_RING_MESSAGE{ slot, position, reinterpret_cast<uint8_t*>(slot + 1), header->slot_size, 0 };
+                return true;
+            }
+        }
+
+        /*
+         * Reserve a slot, spin until the consumer releases one
+         * @return reserved message
+         */
+        DB_RING_MESSAGE Reserve() {
+            DB_RING_MESSAGE message;
+            for (size_t spin = 0; !TryReserve(message); spin++) {
+                if (spin > 64) {
+                    std::this_thread::yield();
+                }
+            }
+            return message;
+        }
+
+        /*
+         * Publish a reserved message to the consumer
+         * @param message reserved message
+         * @param size data size
+         * @param type user message type
+         */
+        void Commit(DB_RING_MESSAGE& message, size_t size, uint32_t type = 0) {
+            if (size > Header()->slot_size) {
+                DBFLIB_THROW("message too big for the ring slot");
+            }
+            message.slot->size = (uint32_t)size;
+            message.slot->type = type;
+            message.slot->sequence.store(message.position + 1, std::memory_order_release);
+        }
+
+        /*
+         * Publish a message built in place
+         * @param message reserved message
+         * @param builder message builder
+         * @param type user message type
+         */
+        void Commit(DB_RING_MESSAGE& message, const DBRingMessageBuilder& builder, uint32_t type = 0) {
+            Commit(message, builder.Size(), type);
+        }
+
+        /*
+         * Read the next message without waiting, only one thread can consume the ring
+         * @param message output message, valid until released
+         * @return false if the ring is empty
+         */
+        bool TryPeek(DB_RING_MESSAGE& message) {
+            DB_RING_HEADER* header = Header();
+            uint64_t position = header->head.load(std::memory_order_relaxed);
+            DB_RING_SLOT* slot = Slot(position);
+            if (slot->sequence.load(std::memory_order_acquire) != position + 1) {
+                return false;
+            }
+            if (slot->size > header->slot_size) {
+                DBFLIB_THROW("invalid ring: message too big");
+            }
+            message = DB_RING_MESSAGE{ slot, position, reinterpret_cast<uint8_t*>(slot + 1), slot->size, slot->type };
+            return true;
+        }
+
+        /*
+         * Read the next message, spin until a producer commits one
+         * @return message, valid until released
+         */
+        DB_RING_MESSAGE Peek() {
+            DB_RING_MESSAGE message;
+            for (size_t spin = 0; !TryPeek(message); spin++) {
+                if (spin > 64) {
+                    std::this_thread::yield();
+                }
+            }
+            return message;
+        }
+
+        /*
+         * Release a read message, its slot can be reused by the producers
+         * @param message read message
+         */
+        void Release(const DB_RING_MESSAGE& message) {
+            DB_RING_HEADER* header = Header();
+            header->head.store(message.position + 1, std::memory_order_relaxed);
+            message.slot->sequence.store(message.position + header->slot_count, std::memory_order_release);
+        }
+    };
+#endif
+}
@@ -0,0 +1,275 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <queue>
+#include <span>
+#include <type_traits>
+
+/*
+ * Packed Hilbert R-tree blocks
+ */
+namespace dbflib {
+    struct DB_RTREE_BOX {
+        float min_x{};
+        float min_y{};
+        float max_x{};
+        float max_y{};
+
+        /*
+         * Test if 2 boxes are intersecting
+         * @param o other box
+         * @return true if the boxes are intersecting
+         */
+        bool Intersects(const DB_RTREE_BOX& o) const {
+#ifdef DBFLIB_SSE2
+            // (min_x, min_y, -max_x, -max_y) <= (o.max_x, o.max_y, -o.min_x, -o.min_y)
+            const __m128 sign = _mm_castsi128_ps(_mm_setr_epi32(0, 0, INT32_MIN, INT32_MIN));
+            __m128 a = _mm_xor_ps(_mm_loadu_ps(&min_x), sign);
+            __m128 b = _mm_xor_ps(_mm_shuffle_ps(_mm_loadu_ps(&o.min_x), _mm_loadu_ps(&o.min_x), _MM_SHUFFLE(1, 0, 3, 2)), sign);
+            return _mm_movemask_ps(_mm_cmple_ps(a, b)) == 0xF;
+#else
+            return min_x <= o.max_x && min_y <= o.max_y && max_x >= o.min_x && max_y >= o.min_y;
+#endif
+        }
+
+        /*
+         * Squared distance between the box and a point
+         * @param x point x
+         * @param y point y
+         * @return distance, 0 if the point is inside the box
+         */
+        float Distance(float x, float y) const {
+            float dx = std::max({ min_x - x, 0.0f, x - max_x });
+            float dy = std::max({ min_y - y, 0.0f, y - max_y });
+            return dx * dx + dy * dy;
+        }
+    };
+
+    /*
+     * Static R-tree, the items are sorted by the Hilbert value of their centers and packed by nodes of node_size entries.
+     * The entries are stored level by level from the items to the root, the last entry. The entries of the level l are
+     * in [level_bounds[l - 1], level_bounds[l]), the index of an item entry is the item id, the index of a node entry
+     * is the entry of its first child.
+     */
+    struct DB_RTREE {
+        uint32_t count{};
+        uint32_t node_size{};
+        uint32_t entry_count{};
+        uint32_t level_count{};
+        DB_RTREE_BOX* boxes{};
+        uint32_t* indices{};
+        uint32_t* level_bounds{};
+
+        /*
+         * Find the items intersecting a box
+         * @param box box
+         * @param func callback (uint32_t id), can return false to stop the search
+         */
+        template<typename Func>
+        void Search(const DB_RTREE_BOX& box, Func&& func) const {
+            if (!count) {
+                return;
+            }
+            // (entry, level)
+            std::vector<std::pair<uint32_t, uint32_t>> stack{};
+            stack.emplace_back(entry_count - 1, level_count - 1);
+            while (!stack.empty()) {
+                auto [node, level] = stack.back();
+                stack.pop_back();
+                uint32_t first = indices[node];
+                uint32_t end = std::min(first + node_size, level_bounds[level - 1]);
+                for (uint32_t e = first; e < end; e++) {
+                    if (!boxes[e].Intersects(box)) {
+                        continue;
+                    }
+                    if (level > 1) {
+                        stack.emplace_back(e, level - 1);
+                    } else if constexpr (std::is_convertible_v<std::invoke_result_t<Func, uint32_t>, bool>) {
+                        if (!func(indices[e])) {
+                            return;
+                        }
+                    } else {
+                        func(indices[e]);
+                    }
+                }
+            }
+        }
+
+        /*
+         * Find the items intersecting a box
+         * @param box box
+         * @return item ids
+         */
+        std::vector<uint32_t> Search(const DB_RTREE_BOX& box) const {
+            std::vector<uint32_t> ids{};
+            Search(box, [&ids](uint32_t id) { ids.push_back(id); });
+            return ids;
+        }
+
+        /*
+         * Find the nearest items of a point
+         * @param x point x
+         * @param y point y
+         * @param k max item count
+         * @param maxDistance max distance of the items
+         * @return (squared distance, id) of the items, sorted by distance
+         */
+        std::vector<std::pair<float, uint32_t>> Neighbors(float x, float y, size_t k, float maxDistance = std::numeric_limits<float>::infinity()) const {
+            std::vector<std::pair<float, uint32_t>> results{};
+            if (!count || !k) {
+                return results;
+            }
+            float maxSq = maxDistance * maxDistance;
+
+            struct Entry {
+                float distance;
+                uint32_t entry;
+                uint32_t level; // 0 for the items
+
+                bool operator>(const Entry& o) const {
+                    return distance > o.distance;
+                }
+            };
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue{};
+            queue.push(Entry{ 0, entry_count - 1, level_count - 1 });
+            while (!queue.empty()) {
+                Entry top = queue.top();
+                queue.pop();
+                if (top.distance > maxSq) {
+                    break;
+                }
+                if (!top.level) {
+                    results.emplace_back(top.distance, indices[top.entry]);
+                    if (results.size() == k) {
+                        break;
+                    }
+                    continue;
+                }
+                uint32_t first = indices[top.entry];
+                uint32_t end = std::min(first + node_size, level_bounds[top.level - 1]);
+                for (uint32_t e = first; e < end; e++) {
+                    queue.push(Entry{ boxes[e].Distance(x, y), e, top.level - 1 });
+                }
+            }
+            return results;
+        }
+    };
+
+    namespace rtree {
+        /*
+         * Hilbert curve index of a point in a 2^16 x 2^16 grid
+         * @param x x coordinate
+         * @param y y coordinate
+         * @return index
+         */
+        constexpr uint32_t HilbertIndex(uint32_t x, uint32_t y) {
+            uint32_t d = 0;
+            for (uint32_t s = 1u << 15; s; s >>= 1) {
+                uint32_t rx = (x & s) ? 1 : 0;
+                uint32_t ry = (y & s) ? 1 : 0;
+                d += s * s * ((3 * rx) ^ ry);
+                if (!ry) {
+                    if (rx) {
+                        x = s - 1 - (x & (s - 1));
+                        y = s - 1 - (y & (s - 1));
+                    }
+                    std::swap(x, y);
+                }
+            }
+            return d;
+        }
+    }
+
+    /*
+     * Bulk load a packed Hilbert R-tree.
+     * @param builder builder
+     * @param items item boxes, the id of an item is its index
+     * @param nodeSize entries per node
+     * @return block id of the DB_RTREE
+     */
+    inline BlockId CreateRTree(DBFileBuilder& builder, std::span<const DB_RTREE_BOX> items, uint32_t nodeSize = 16) {
+        if (nodeSize < 2) {
+            DBFLIB_THROW("invalid r-tree node size");
+        }
+        if (items.size() > INT32_MAX / sizeof(DB_RTREE_BOX)) {
+            DBFLIB_THROW("file too big");
+        }
+        uint32_t count = (uint32_t)items.size();
+
+        DB_RTREE_BOX extent{
+            std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity(),
+            -std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+        };
+        for (const DB_RTREE_BOX& b : items) {
+            extent.min_x = std::min(extent.min_x, b.min_x);
+            extent.min_y = std::min(extent.min_y, b.min_y);
+            extent.max_x = std::max(extent.max_x, b.max_x);
+            extent.max_y = std::max(extent.max_y, b.max_y);
+        }
+        float width = extent.max_x - extent.min_x;
+        float height = extent.max_y - extent.min_y;
+
+        std::vector<uint32_t> hilbert(count);
+        for (uint32_t i = 0; i < count; i++) {
+            const DB_RTREE_BOX& b = items[i];
+            float cx = width > 0 ? ((b.min_x + b.max_x) / 2 - extent.min_x) / width : 0;
+            float cy = height > 0 ? ((b.min_y + b.max_y) / 2 - extent.min_y) / height : 0;
+            hilbert[i] = rtree::HilbertIndex((uint32_t)(cx * 65535), (uint32_t)(cy * 65535));
+        }
+        std::vector<uint32_t> order(count);
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&hilbert](uint32_t a, uint32_t b) { return hilbert[a] < hilbert[b]; });
+
+        std::vector<DB_RTREE_BOX> boxes{};
+        std::vector<uint32_t> indices{};
+        std::vector<uint32_t> levelBounds{};
+        for (uint32_t id : order) {
+            boxes.push_back(items[id]);
+            indices.push_back(id);
+        }
+        levelBounds.push_back(count);
+
+        if (count) {
+            uint32_t levelStart = 0;
+            do {
+                uint32_t levelEnd = (uint32_t)boxes.size();
+                for (uint32_t first = levelStart; first < levelEnd; first += nodeSize) {
+                    DB_RTREE_BOX node = boxes[first];
+                    for (uint32_t e = first + 1; e < std::min(first + nodeSize, levelEnd); e++) {
+                        node.min_x = std::min(node.min_x, boxes[e].min_x);
+                        node.min_y = std::min(node.min_y, boxes[e].min_y);
+                        node.max_x = std::max(node.max_x, boxes[e].max_x);
+                        node.max_y = std::max(node.max_y, boxes[e].max_y);
+                    }
+                    boxes.push_back(node);
+                    indices.push_back(first);
+                }
+                levelStart = levelEnd;
+                levelBounds.push_back((uint32_t)boxes.size());
+            } while (boxes.size() - levelStart > 1);
+        }
+        // keep valid pointers for the empty trees
+        boxes.emplace_back();
+        indices.push_back(0);
+
+        builder.AlignBlock();
+        auto [treeId, tree] = builder.CreateBlock<DB_RTREE>();
+        tree->count = count;
+        tree->node_size = nodeSize;
+        tree->entry_count = (uint32_t)boxes.size() - 1;
+        tree->level_count = (uint32_t)levelBounds.size();
+
+        builder.AlignBlock<DB_RTREE_BOX>();
+        BlockId boxesId = builder.CreateBlock(boxes.data(), boxes.size() * sizeof(boxes[0]));
+        BlockId indicesId = builder.CreateBlock(indices.data(), indices.size() * sizeof(indices[0]));
+        BlockId levelBoundsId = builder.CreateBlock(levelBounds.data(), levelBounds.size() * sizeof(levelBounds[0]));
+        builder.CreateLink(treeId, offsetof(DB_RTREE, boxes), boxesId);
+        builder.CreateLink(treeId, offsetof(DB_RTREE, indices), indicesId);
+        builder.CreateLink(treeId, offsetof(DB_RTREE, level_bounds), levelBoundsId);
+
+        return treeId;
+    }
+}
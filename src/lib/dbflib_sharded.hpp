@@ -0,0 +1,250 @@
+#pragma once
+#include "dbflib.hpp"
+#include <memory>
+#include <string>
+
+/*
+ * Sharded files, a dataset split in multiple files described by a manifest
+ */
+namespace dbflib {
+    struct DB_SHARD_ROOT {
+        uint32_t shard;
+        uint32_t offset;
+    };
+
+    struct DB_SHARD_INFO {
+        uint64_t file_size;
+        uint32_t first_root;
+        uint32_t root_count;
+        // path relative to the manifest directory, null terminated
+        char* path;
+    };
+
+    /*
+     * Manifest file start
+     */
+    struct DB_SHARD_MANIFEST {
+        uint32_t shard_count;
+        uint32_t root_count;
+        DB_SHARD_INFO* shards;
+        DB_SHARD_ROOT* roots;
+    };
+
+    /*
+     * Write a dataset into size bounded shard files. The links can't cross the shards, so the blocks of a root are
+     * created in the same shard: Builder returns the builder of the current shard and starts a new shard if the
+     * reserved size doesn't fit in it. The manifest is written as "<name>.manifest.dbf" by Finish.
+     */
+    class DBShardedFileBuilder {
+        std::filesystem::path manifestPath;
+        std::string name;
+        std::vector<std::filesystem::path> directories;
+        size_t shardSize;
+        uint8_t flags;
+        std::unique_ptr<DBFileBuilder> current{};
+        std::vector<std::string> shardPaths{};
+        std::vector<uint64_t> shardSizes{};
+        std::vector<uint32_t> shardFirstRoots{};
+        std::vector<DB_SHARD_ROOT> roots{};
+        bool finished{};
+
+        void StartShard() {
+            current = std::make_unique<DBFileBuilder>(flags);
+            shardFirstRoots.push_back((uint32_t)roots.size());
+        }
+    public:
+        /*
+         * @param directory manifest directory
+         * @param name dataset name, prefix of the files
+         * @param shardSize max size of a shard, a root bigger than this size is written alone in its shard
+         * @param flags builder options of the shards, described in DB_FILE_BUILDER_OPTIONS
+         * @param shardDirectories directories of the shards, used in turn to spread the shards across devices,
+         * the manifest directory if empty
+         */
+        DBShardedFileBuilder(const std::filesystem::path& directory, std::string name, size_t shardSize = INT32_MAX,
+            uint8_t flags = 0, std::vector<std::filesystem::path> shardDirectories = {})
+            : manifestPath(std::filesystem::absolute(directory) / (name + ".manifest.dbf")), name(std::move(name)),
+            directories(std::move(shardDirectories)), shardSize(std::min<size_t>(shardSize, INT32_MAX)), flags(flags) {
+            if (directories.empty()) {
+                directories.push_back(directory);
+            }
+        }
+
+        DBShardedFileBuilder(DBShardedFileBuilder& o) = delete;
+        DBShardedFileBuilder(DBShardedFileBuilder&& o) = delete;
+
+        /*
+         * Get the builder of the current shard, the shard is written if the reserved size or links don't fit in it.
+         * The block ids and pointers of a builder are only valid until the next shard is started.
+         * @param reserve size of the blocks to create
+         * @param reserveLinks count of the links to create
+         * @return builder
+         */
+        DBFileBuilder& Builder(size_t reserve = 0, size_t reserveLinks = 0) {
+            if (finished) {
+                DBFLIB_THROW("sharded builder already finished");
+            }
+            if (!current) {
+                StartShard();
+            } else if (current->GetFileSize() > sizeof(DB_FILE)
+                && (current->GetFileSize() + reserve + (current->GetLinksCount() + reserveLinks + 1) * sizeof(DB_FILE_LINK) > shardSize
+                    || current->GetLinksCount() + reserveLinks > UINT16_MAX)) {
+                Flush();
+                StartShard();
+            }
+            return *current;
+        }
+
+        /*
+         * Add a root of the current shard
+         * @param id root block id in the current builder
+         * @return root index in the dataset
+         */
+        size_t AddRoot(BlockId id) {
+            if (!current) {
+                DBFLIB_THROW("no shard started");
+            }
+            roots.emplace_back((uint32_t)shardPaths.size(), id);
+            return roots.size() - 1;
+        }
+
+        /*
+         * Write the current shard, the next call to Builder starts a new shard
+         */
+        void Flush() {
+            if (!current) {
+                return;
+            }
+            std::filesystem::path dir = std::filesystem::absolute(directories[shardPaths.size() % directories.size()]);
+            std::filesystem::path path = dir / (name + "." + std::to_string(shardPaths.size()) + ".dbf");
+            current->WriteToFile(path);
+            shardSizes.push_back(std::filesystem::file_size(path));
+            shardPaths.push_back(path.lexically_relative(manifestPath.parent_path()).generic_string());
+            current.reset();
+        }
+
+        /*
+         * Write the last shard and the manifest
+         * @return manifest path
+         */
+        std::filesystem::path Finish() {
+            if (finished) {
+                return manifestPath;
+            }
+            Flush();
+            finished = true;
+
+            DBFileBuilder manifest{ DBFBO_ALIGN };
+            auto [manifestId, m] = manifest.CreateBlock<DB_SHARD_MANIFEST>();
+            m->shard_count = (uint32_t)shardPaths.size();
+            m->root_count = (uint32_t)roots.size();
+
+            std::vector<DB_SHARD_INFO> shards(shardPaths.size() + 1);
+            for (size_t i = 0; i < shardPaths.size(); i++) {
+                shards[i].file_size = shardSizes[i];
+                shards[i].first_root = shardFirstRoots[i];
+                shards[i].root_count = (uint32_t)((i + 1 < shardPaths.size() ? shardFirstRoots[i + 1] : roots.size()) - shardFirstRoots[i]);
+            }
+            // keep valid pointers without shard or root
+            std::vector<DB_SHARD_ROOT> rootsData{ roots };
+            rootsData.emplace_back();
+            BlockId shardsId = manifest.CreateBlock(shards.data(), shards.size() * sizeof(shards[0]));
+            BlockId rootsId = manifest.CreateBlock(rootsData.data(), rootsData.size() * sizeof(rootsData[0]));
+            manifest.CreateLink(manifestId, offsetof(DB_SHARD_MANIFEST, shards), shardsId);
+            manifest.CreateLink(manifestId, offsetof(DB_SHARD_MANIFEST, roots), rootsId);
+            for (size_t i = 0; i < shardPaths.size(); i++) {
+                BlockId pathId = manifest.CreateBlock(shardPaths[i].c_str(), shardPaths[i].size() + 1);
+                manifest.CreateLink(shardsId, (BlockOffset)(i * sizeof(DB_SHARD_INFO) + offsetof(DB_SHARD_INFO, path)), pathId);
+            }
+            manifest.WriteToFile(manifestPath);
+            return manifestPath;
+        }
+    };
+
+    /*
+     * Load all the shards of a dataset in parallel and expose their roots as one dataset
+     */
+    class DBShardedFileReader {
+        std::unique_ptr<DBFileReader> manifestReader;
+        DB_SHARD_MANIFEST* manifest;
+        std::vector<std::unique_ptr<DBFileReader>> shards{};
+    public:
+        /*
+         * @param manifestPath manifest path
+         * @param options reader options of the shards, described in DB_FILE_READER_OPTIONS
+         * @param executor executor loading the shards
+         */
+        DBShardedFileReader(const std::filesystem::path& manifestPath, uint32_t options = 0, DBExecutor& executor = DefaultExecutor())
+            : manifestReader(std::make_unique<DBFileReader>(manifestPath)) {
+            manifest = manifestReader->GetStart<DB_SHARD_MANIFEST>();
+            std::filesystem::path dir = manifestPath.parent_path();
+
+            shards.resize(manifest->shard_count);
+            executor.Run(manifest->shard_count, [this, &dir, options, &executor](size_t i) {
+                const DB_SHARD_INFO& info = manifest->shards[i];
+                auto shard = std::make_unique<DBFileReader>(dir / info.path, options, executor);
+                if (shard->GetFile()->file_size != info.file_size) {
+                    DBFLIB_THROW("invalid shard: bad file size");
+                }
+                shards[i] = std::move(shard);
+            });
+
+            for (size_t i = 0; i < manifest->root_count; i++) {
+                const DB_SHARD_ROOT& root = manifest->roots[i];
+                if (root.shard >= manifest->shard_count || root.offset >= shards[root.shard]->GetFile()->file_size) {
+                    DBFLIB_THROW("invalid manifest: root after shard end");
+                }
+            }
+        }
+
+        DBShardedFileReader(DBShardedFileReader& o) = delete;
+        DBShardedFileReader(DBShardedFileReader&& o) = delete;
+
+        /*
+         * @return shard count
+         */
+        size_t ShardCount() const {
+            return shards.size();
+        }
+
+        /*
+         * Get a shard reader
+         * @param id shard id
+         * @return reader
+         */
+        DBFileReader& GetShard(size_t id) {
+            return *shards[id];
+        }
+
+        /*
+         * @return root count of the dataset
+         */
+        size_t RootCount() const {
+            return manifest->root_count;
+        }
+
+        /*
+         * Get a root of the dataset
+         * @param RootType return type
+         * @param id root index
+         * @return root
+         */
+        template<typename RootType = void>
+        RootType* GetRoot(size_t id) {
+            const DB_SHARD_ROOT& root = manifest->roots[id];
+            return reinterpret_cast<RootType*>(shards[root.shard]->GetFile()->magic + root.offset);
+        }
+
+        /*
+         * Iterate over the roots of the dataset in order
+         * @param RootType root type
+         * @param func callback (RootType* root)
+         */
+        template<typename RootType = void, typename Func>
+        void ForEachRoot(Func&& func) {
+            for (size_t i = 0; i < manifest->root_count; i++) {
+                func(GetRoot<RootType>(i));
+            }
+        }
+    };
+}
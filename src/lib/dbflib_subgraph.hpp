@@ -0,0 +1,153 @@
+#pragma once
+#include "dbflib.hpp"
+#include <cstring>
+#include <unordered_map>
+
+/*
+ * Subgraph extraction
+ */
+namespace dbflib {
+    /*
+     * Extract the blocks reachable from a root into a new file. The file should be built with the DBFBO_BLOCK_TABLE
+     * option, the links are indexed by origin once, so an extraction only visits the blocks and links of the subgraph.
+     * The symbol links are extracted as symbol links, a bound symbol isn't copied as an address.
+     */
+    class DBSubgraphExtractor {
+        DB_FILE* file;
+        const DB_FILE_BLOCK* blocks{};
+        size_t blockCount{};
+        // links sorted by origin
+        std::vector<DB_FILE_LINK> links{};
+        // symbol links sorted by origin
+        std::vector<DB_FILE_SYMBOL_LINK> symbols{};
+
+        // find the block containing an offset, a block end is contained if no other block starts there
+        size_t FindBlock(uint32_t offset) const {
+            const DB_FILE_BLOCK* it = std::upper_bound(blocks, blocks + blockCount, offset, [](uint32_t o, const DB_FILE_BLOCK& b) { return o < b.offset; });
+            if (it == blocks || offset > (it - 1)->offset + (it - 1)->size) {
+                DBFLIB_THROW("link outside of the block table");
+            }
+            return (size_t)(it - blocks) - 1;
+        }
+
+        // links with an origin in a block
+        template<typename LinkType>
+        static std::pair<const LinkType*, const LinkType*> BlockLinks(const std::vector<LinkType>& links, const DB_FILE_BLOCK& block) {
+            const LinkType* begin = std::lower_bound(links.data(), links.data() + links.size(), block.offset, [](const LinkType& l, uint32_t o) { return l.origin < o; });
+            const LinkType* end = begin;
+            while (end != links.data() + links.size() && end->origin < block.offset + block.size) {
+                end++;
+            }
+            return { begin, end };
+        }
+    public:
+        /*
+         * Index a file, the file can be linked or not
+         * @param file file, validated
+         */
+        DBSubgraphExtractor(DB_FILE* file) : file(file) {
+            size_t size{};
+            blocks = file->GetExtension<const DB_FILE_BLOCK>(DBFE_BLOCKS, &size);
+            if (!blocks) {
+                DBFLIB_THROW("file without block table");
+            }
+            blockCount = size / sizeof(DB_FILE_BLOCK);
+            for (size_t i = 0; i < blockCount; i++) {
+                if ((size_t)blocks[i].offset + blocks[i].size > file->file_size || (i && blocks[i].offset < blocks[i - 1].offset + blocks[i - 1].size)) {
+                    DBFLIB_THROW("invalid block table");
+                }
+            }
+            if (file->version >= DB_FILE_VERSION_FEATURE::LINKING) {
+                const DB_FILE_LINK* table = reinterpret_cast<const DB_FILE_LINK*>(file->magic + file->links_table_offset);
+                links.assign(table, table + file->links_count);
+            }
+            std::sort(links.begin(), links.end(), [](const DB_FILE_LINK& a, const DB_FILE_LINK& b) { return a.origin < b.origin; });
+            const DB_FILE_SYMBOL_LINK* fileSymbols = file->GetExtension<const DB_FILE_SYMBOL_LINK>(DBFE_SYMBOLS, &size);
+            if (fileSymbols) {
+                symbols.assign(fileSymbols, fileSymbols + size / sizeof(DB_FILE_SYMBOL_LINK));
+                std::sort(symbols.begin(), symbols.end(), [](const DB_FILE_SYMBOL_LINK& a, const DB_FILE_SYMBOL_LINK& b) { return a.origin < b.origin; });
+            }
+        }
+
+        DBSubgraphExtractor(DBSubgraphExtractor& o) = delete;
+        DBSubgraphExtractor(DBSubgraphExtractor&& o) = delete;
+
+        /*
+         * Copy the blocks reachable from a root into a builder, the root block is created first
+         * @param root root pointer, inside a block of the file
+         * @param builder output builder
+         * @return root block id in the builder
+         */
+        BlockId Extract(const void* root, DBFileBuilder& builder) const {
+            size_t rootOffset = (size_t)(reinterpret_cast<const uint8_t*>(root) - file->magic);
+            if (rootOffset > file->file_size) {
+                DBFLIB_THROW("root outside of the file");
+            }
+            size_t rootBlock = FindBlock((uint32_t)rootOffset);
+
+            // find the reachable blocks
+            std::unordered_map<size_t, BlockId> ids{};
+            std::vector<size_t> order{ rootBlock };
+            ids.emplace(rootBlock, 0);
+            for (size_t i = 0; i < order.size(); i++) {
+                auto [begin, end] = BlockLinks(links, blocks[order[i]]);
+                for (const DB_FILE_LINK* link = begin; link != end; link++) {
+                    size_t destination = FindBlock(link->destination);
+                    if (ids.emplace(destination, 0).second) {
+                        order.push_back(destination);
+                    }
+                }
+            }
+
+            // copy the blocks without the old pointers and symbol addresses
+            for (size_t index : order) {
+                const DB_FILE_BLOCK& block = blocks[index];
+                auto [id, ptr] = builder.CreateBlock<uint8_t>(block.size);
+                std::memcpy(ptr, file->magic + block.offset, block.size);
+                auto [begin, end] = BlockLinks(links, block);
+                for (const DB_FILE_LINK* link = begin; link != end; link++) {
+                    if ((size_t)link->origin + sizeof(void*) > (size_t)block.offset + block.size) {
+                        DBFLIB_THROW("link outside of the block table");
+                    }
+                    std::memset(ptr + (link->origin - block.offset), 0, sizeof(void*));
+                }
+                auto [symbolsBegin, symbolsEnd] = BlockLinks(symbols, block);
+                for (const DB_FILE_SYMBOL_LINK* symbol = symbolsBegin; symbol != symbolsEnd; symbol++) {
+                    if ((size_t)symbol->origin + sizeof(void*) > (size_t)block.offset + block.size) {
+                        DBFLIB_THROW("symbol link outside of the block table");
+                    }
+                    std::memset(ptr + (symbol->origin - block.offset), 0, sizeof(void*));
+                }
+                ids[index] = id;
+            }
+
+            for (size_t index : order) {
+                const DB_FILE_BLOCK& block = blocks[index];
+                auto [begin, end] = BlockLinks(links, block);
+                for (const DB_FILE_LINK* link = begin; link != end; link++) {
+                    size_t destination = FindBlock(link->destination);
+                    builder.CreateLink(ids[index], link->origin - block.offset, ids[destination], link->destination - blocks[destination].offset);
+                }
+                auto [symbolsBegin, symbolsEnd] = BlockLinks(symbols, block);
+                for (const DB_FILE_SYMBOL_LINK* symbol = symbolsBegin; symbol != symbolsEnd; symbol++) {
+                    builder.CreateSymbolLink(ids[index], symbol->origin - block.offset, symbol->hash);
+                }
+            }
+            return ids[rootBlock];
+        }
+
+        /*
+         * Extract the blocks reachable from a root into a file, the root is the start of the new file
+         * @param root root pointer, inside a block of the file
+         * @param path output path
+         * @param flags builder options, described in DB_FILE_BUILDER_OPTIONS
+         */
+        void ExtractToFile(const void* root, const std::filesystem::path& path, uint8_t flags = DBFBO_ALIGN | DBFBO_BLOCK_TABLE) const {
+            DBFileBuilder builder{ flags };
+            BlockId id = Extract(root, builder);
+            size_t rootOffset = (size_t)(reinterpret_cast<const uint8_t*>(root) - file->magic);
+            builder.SetStart(id, (BlockOffset)(rootOffset - blocks[FindBlock((uint32_t)rootOffset)].offset));
+            builder.WriteToFile(path);
+        }
+    };
+}
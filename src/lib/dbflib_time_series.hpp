@@ -0,0 +1,294 @@
+#pragma once
+#include "dbflib.hpp"
+#include "dbflib_utils.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+/*
+ * Gorilla compressed time series blocks
+ */
+namespace dbflib {
+    struct DB_TIME_SERIES_POINT {
+        int64_t timestamp{};
+        double value{};
+    };
+
+    /*
+     * Chunk index entry, the first point is stored raw in the entry, the next points are stored
+     * in the series data at offset as a bit stream of delta of delta timestamps and xor values.
+     */
+    struct DB_TIME_SERIES_CHUNK {
+        int64_t first_timestamp{};
+        int64_t last_timestamp{};
+        double first_value{};
+        uint32_t offset{};
+        uint32_t count{};
+    };
+
+    struct DB_TIME_SERIES {
+        uint64_t point_count{};
+        uint32_t chunk_count{};
+        uint32_t __pad{};
+        DB_TIME_SERIES_CHUNK* chunks{};
+        uint8_t* data{};
+
+        /*
+         * Find the first chunk which can contain a timestamp
+         * @param timestamp timestamp
+         * @return chunk index, chunk_count if all the points are before the timestamp
+         */
+        uint32_t FindChunk(int64_t timestamp) const {
+            return (uint32_t)(std::partition_point(chunks, chunks + chunk_count, [timestamp](const DB_TIME_SERIES_CHUNK& c) {
+                return c.last_timestamp < timestamp;
+            }) - chunks);
+        }
+
+        /*
+         * Decode the points in a time range
+         * @param from first timestamp, inclusive
+         * @param to last timestamp, inclusive
+         * @param func callback (const DB_TIME_SERIES_POINT& point), can return false to stop the scan
+         */
+        template<typename Func>
+        void Scan(int64_t from, int64_t to, Func&& func) const;
+    };
+
+    /*
+     * Streaming time series decoder
+     */
+    class DBTimeSeriesDecoder {
+        const DB_TIME_SERIES* series;
+        uint32_t chunk;
+        uint32_t index{};
+        uint64_t bit{};
+        int64_t timestamp{};
+        int64_t delta{};
+        uint64_t value{};
+        uint32_t leading{};
+        uint32_t trailing{};
+
+        uint64_t ReadBits(uint32_t n) {
+            if (n > 56) {
+                uint64_t high = ReadBits(n - 32);
+                return (high << 32) | ReadBits(32);
+            }
+            if (!n) {
+                return 0;
+            }
+            uint64_t word;
+            std::memcpy(&word, series->data + (bit >> 3), sizeof(word));
+            if constexpr (std::endian::native == std::endian::little) {
+                word = ByteSwap(word);
+            }
+            uint64_t v = (word << (bit & 7)) >> (64 - n);
+            bit += n;
+            return v;
+        }
+
+        static constexpr uint64_t ByteSwap(uint64_t v) {
+            v = ((v & 0x00FF00FF00FF00FFull) << 8) | ((v >> 8) & 0x00FF00FF00FF00FFull);
+            v = ((v & 0x0000FFFF0000FFFFull) << 16) | ((v >> 16) & 0x0000FFFF0000FFFFull);
+            return (v << 32) | (v >> 32);
+        }
+    public:
+        /*
+         * @param series series
+         * @param chunk first chunk to decode
+         */
+        DBTimeSeriesDecoder(const DB_TIME_SERIES& series, uint32_t chunk = 0) : series(&series), chunk(chunk) {}
+
+        /*
+         * Decode the next point
+         * @param point output
+         * @return false if the end of the series was reached
+         */
+        bool Next(DB_TIME_SERIES_POINT& point) {
+            if (chunk >= series->chunk_count) {
+                return false;
+            }
+            const DB_TIME_SERIES_CHUNK& c = series->chunks[chunk];
+            if (!index) {
+                bit = (uint64_t)c.offset * 8;
+                timestamp = c.first_timestamp;
+                delta = 0;
+                value = std::bit_cast<uint64_t>(c.first_value);
+                leading = UINT32_MAX;
+                trailing = 0;
+            } else {
+                int64_t dod;
+                if (!ReadBits(1)) {
+                    dod = 0;
+                } else if (!ReadBits(1)) {
+                    dod = (int64_t)ReadBits(7) - 63;
+                } else if (!ReadBits(1)) {
+                    dod = (int64_t)ReadBits(9) - 255;
+                } else if (!ReadBits(1)) {
+                    dod = (int64_t)ReadBits(12) - 2047;
+                } else {
+                    dod = (int64_t)ReadBits(64);
+                }
+                delta += dod;
+                timestamp += delta;
+
+                if (ReadBits(1)) {
+                    if (ReadBits(1)) {
+                        leading = (uint32_t)ReadBits(5);
+                        uint32_t meaningful = (uint32_t)ReadBits(6) + 1;
+                        trailing = 64 - leading - meaningful;
+                    }
+                    value ^= ReadBits(64 - leading - trailing) << trailing;
+                }
+            }
+            point.timestamp = timestamp;
+            point.value = std::bit_cast<double>(value);
+
+            if (++index == c.count) {
+                index = 0;
+                chunk++;
+            }
+            return true;
+        }
+    };
+
+    template<typename Func>
+    void DB_TIME_SERIES::Scan(int64_t from, int64_t to, Func&& func) const {
+        DBTimeSeriesDecoder decoder{ *this, FindChunk(from) };
+        DB_TIME_SERIES_POINT point;
+        while (decoder.Next(point) && point.timestamp <= to) {
+            if (point.timestamp < from) {
+                continue;
+            }
+            if constexpr (std::is_convertible_v<std::invoke_result_t<Func, const DB_TIME_SERIES_POINT&>, bool>) {
+                if (!func(point)) {
+                    return;
+                }
+            } else {
+                func(point);
+            }
+        }
+    }
+
+    /*
+     * Create a Gorilla compressed time series.
+     * @param builder builder
+     * @param points points sorted by timestamp
+     * @param pointsPerChunk points per chunk, a scan is decoding at most one chunk before its first point
+     * @return block id of the DB_TIME_SERIES
+     */
+    inline BlockId CreateTimeSeries(DBFileBuilder& builder, std::span<const DB_TIME_SERIES_POINT> points, uint32_t pointsPerChunk = 1024) {
+        if (!pointsPerChunk) {
+            DBFLIB_THROW("invalid time series chunk size");
+        }
+        std::vector<uint8_t> data{};
+        std::vector<DB_TIME_SERIES_CHUNK> chunks{};
+        uint64_t buffer = 0;
+        uint32_t buffered = 0;
+
+        // write the n low bits of v, most significant bit first
+        auto write = [&](uint64_t v, uint32_t n) {
+            auto writeSmall = [&](uint64_t w, uint32_t len) {
+                buffer = (buffer << len) | (w & ((1ull << len) - 1));
+                buffered += len;
+                while (buffered >= 8) {
+                    buffered -= 8;
+                    data.push_back((uint8_t)(buffer >> buffered));
+                }
+            };
+            if (n > 32) {
+                writeSmall(v >> 32, n - 32);
+                n = 32;
+            }
+            writeSmall(v, n);
+        };
+
+        for (size_t start = 0; start < points.size(); start += pointsPerChunk) {
+            size_t end = std::min(points.size(), start + pointsPerChunk);
+            if (start && points[start].timestamp < points[start - 1].timestamp) {
+                DBFLIB_THROW("time series points should be sorted");
+            }
+            DB_TIME_SERIES_CHUNK& chunk = chunks.emplace_back();
+            chunk.first_timestamp = points[start].timestamp;
+            chunk.last_timestamp = points[end - 1].timestamp;
+            chunk.first_value = points[start].value;
+            chunk.offset = (uint32_t)data.size();
+            chunk.count = (uint32_t)(end - start);
+
+            int64_t delta = 0;
+            uint64_t prev = std::bit_cast<uint64_t>(points[start].value);
+            uint32_t leading = UINT32_MAX;
+            uint32_t trailing = 0;
+            for (size_t i = start + 1; i < end; i++) {
+                if (points[i].timestamp < points[i - 1].timestamp) {
+                    DBFLIB_THROW("time series points should be sorted");
+                }
+                int64_t d = points[i].timestamp - points[i - 1].timestamp;
+                int64_t dod = d - delta;
+                delta = d;
+                if (!dod) {
+                    write(0, 1);
+                } else if (dod >= -63 && dod <= 64) {
+                    write(0b10, 2);
+                    write((uint64_t)(dod + 63), 7);
+                } else if (dod >= -255 && dod <= 256) {
+                    write(0b110, 3);
+                    write((uint64_t)(dod + 255), 9);
+                } else if (dod >= -2047 && dod <= 2048) {
+                    write(0b1110, 4);
+                    write((uint64_t)(dod + 2047), 12);
+                } else {
+                    write(0b1111, 4);
+                    write((uint64_t)dod, 64);
+                }
+
+                uint64_t v = std::bit_cast<uint64_t>(points[i].value);
+                uint64_t x = v ^ prev;
+                prev = v;
+                if (!x) {
+                    write(0, 1);
+                    continue;
+                }
+                uint32_t lead = std::min<uint32_t>(31, std::countl_zero(x));
+                uint32_t trail = std::countr_zero(x);
+                if (leading != UINT32_MAX && lead >= leading && trail >= trailing) {
+                    // reuse the previous window
+                    write(0b10, 2);
+                } else {
+                    leading = lead;
+                    trailing = trail;
+                    write(0b11, 2);
+                    write(leading, 5);
+                    write(64 - leading - trailing - 1, 6);
+                }
+                write(x >> trailing, 64 - leading - trailing);
+            }
+            // chunks are starting on a byte
+            if (buffered) {
+                data.push_back((uint8_t)(buffer << (8 - buffered)));
+                buffered = 0;
+            }
+            if (data.size() > INT32_MAX) {
+                DBFLIB_THROW("file too big");
+            }
+        }
+        // padding for the 64 bits reads
+        data.resize(data.size() + 8);
+
+        builder.AlignBlock();
+        auto [seriesId, series] = builder.CreateBlock<DB_TIME_SERIES>();
+        series->point_count = points.size();
+        series->chunk_count = (uint32_t)chunks.size();
+
+        // keep a valid pointer without chunk
+        chunks.emplace_back();
+        builder.AlignBlock();
+        BlockId chunksId = builder.CreateBlock(chunks.data(), chunks.size() * sizeof(chunks[0]));
+        BlockId dataId = builder.CreateBlock(data.data(), data.size());
+        builder.CreateLink(seriesId, offsetof(DB_TIME_SERIES, chunks), chunksId);
+        builder.CreateLink(seriesId, offsetof(DB_TIME_SERIES, data), dataId);
+
+        return seriesId;
+    }
+}
@@ -0,0 +1,402 @@
+#pragma once
+#include "dbflib.hpp"
+#include <algorithm>
+#include <bit>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/*
+ * Succinct LOUDS trie blocks
+ */
+namespace dbflib {
+    // number of bits described by one rank sample
+    constexpr uint64_t DB_BIT_VECTOR_RANK_BLOCK = 512;
+
+    /*
+     * Bit vector with rank/select support, ranks are sampled every DB_BIT_VECTOR_RANK_BLOCK bits
+     */
+    struct DB_BIT_VECTOR {
+        uint64_t size{};
+        uint64_t* bits{};
+        uint32_t* ranks{};
+
+        /*
+         * Get a bit
+         * @param i bit index
+         * @return bit value
+         */
+        constexpr bool Get(uint64_t i) const {
+            return (bits[i >> 6] >> (i & 63)) & 1;
+        }
+
+        /*
+         * Count the ones before a position
+         * @param i position
+         * @return ones in [0, i)
+         */
+        uint64_t Rank1(uint64_t i) const {
+            uint64_t block = i / DB_BIT_VECTOR_RANK_BLOCK;
+            uint64_t r = ranks[block];
+            for (uint64_t w = block * (DB_BIT_VECTOR_RANK_BLOCK / 64); w < (i >> 6); w++) {
+                r += std::popcount(bits[w]);
+            }
+            if (i & 63) {
+                r += std::popcount(bits[i >> 6] & ((1ull << (i & 63)) - 1));
+            }
+            return r;
+        }
+
+        /*
+         * Count the zeros before a position
+         * @param i position
+         * @return zeros in [0, i)
+         */
+        uint64_t Rank0(uint64_t i) const {
+            return i - Rank1(i);
+        }
+
+        /*
+         * Find the position of the k-th one
+         * @param k one index, should be lower than the number of ones
+         * @return position
+         */
+        uint64_t Select1(uint64_t k) const {
+            return Select<true>(k);
+        }
+
+        /*
+         * Find the position of the k-th zero
+         * @param k zero index, should be lower than the number of zeros
+         * @return position
+         */
+        uint64_t Select0(uint64_t k) const {
+            return Select<false>(k);
+        }
+
+        /*
+         * Find the first zero at or after a position
+         * @param i position
+         * @return position of the zero, size if none
+         */
+        uint64_t NextZero(uint64_t i) const {
+            uint64_t words = (size + 63) >> 6;
+            uint64_t w = i >> 6;
+            if (w >= words) {
+                return size;
+            }
+            uint64_t v = ~bits[w] & (~0ull << (i & 63));
+            while (!v) {
+                if (++w == words) {
+                    return size;
+                }
+                v = ~bits[w];
+            }
+            uint64_t pos = (w << 6) + std::countr_zero(v);
+            return pos < size ? pos : size;
+        }
+
+    private:
+        template<bool One>
+        uint64_t Select(uint64_t k) const {
+            constexpr uint64_t wordsPerBlock = DB_BIT_VECTOR_RANK_BLOCK / 64;
+            auto before = [this](uint64_t block) -> uint64_t {
+                if constexpr (One) {
+                    return ranks[block];
+                } else {
+                    return block * DB_BIT_VECTOR_RANK_BLOCK - ranks[block];
+                }
+            };
+            // last block with count(block) <= k
+            uint64_t lo = 0;
+            uint64_t hi = (size + DB_BIT_VECTOR_RANK_BLOCK - 1) / DB_BIT_VECTOR_RANK_BLOCK;
+            while (hi - lo > 1) {
+                uint64_t mid = (lo + hi) / 2;
+                if (before(mid) <= k) {
+                    lo = mid;
+                } else {
+                    hi = mid;
+                }
+            }
+            k -= before(lo);
+            uint64_t w = lo * wordsPerBlock;
+            for (;; w++) {
+                uint64_t v = One ? bits[w] : ~bits[w];
+                uint64_t c = std::popcount(v);
+                if (k < c) {
+                    for (; k; k--) {
+                        v &= v - 1;
+                    }
+                    return (w << 6) + std::countr_zero(v);
+                }
+                k -= c;
+            }
+        }
+    };
+
+    /*
+     * Level-order unary degree sequence (LOUDS) trie over a sorted key set.
+     *
+     * Nodes are numbered in breadth first order, the root is the node 0. A node is described in the louds
+     * bit vector by one bit set per child followed by a zero, the label of the node n is labels[n - 1].
+     * The id of a key is the rank of its terminal node, ids are dense in [0, key_count).
+     */
+    struct DB_TRIE {
+        static constexpr uint32_t npos = UINT32_MAX;
+
+        uint32_t key_count{};
+        uint32_t node_count{};
+        DB_BIT_VECTOR louds{};
+        DB_BIT_VECTOR terminals{};
+        uint8_t* labels{};
+
+        /*
+         * Find a key
+         * @param key key
+         * @return key id or npos if the key isn't in the trie
+         */
+        uint32_t Lookup(std::string_view key) const {
+            uint32_t node = FindNode(key);
+            if (node == npos || !terminals.Get(node)) {
+                return npos;
+            }
+            return (uint32_t)terminals.Rank1(node);
+        }
+
+        /*
+         * Test if a key is in the trie
+         * @param key key
+         * @return true if the key is in the trie
+         */
+        bool Contains(std::string_view key) const {
+            uint32_t node = FindNode(key);
+            return node != npos && terminals.Get(node);
+        }
+
+        /*
+         * Get a key from its id
+         * @param id key id, should be lower than key_count
+         * @param out key output
+         */
+        void Key(uint32_t id, std::string& out) const {
+            out.clear();
+            uint64_t node = terminals.Select1(id);
+            while (node) {
+                out.push_back((char)labels[node - 1]);
+                // the parent is the number of nodes terminated before the node's bit
+                node = louds.Select1(node - 1) - (node - 1);
+            }
+            std::reverse(out.begin(), out.end());
+        }
+
+        /*
+         * Get a key from its id
+         * @param id key id, should be lower than key_count
+         * @return key
+         */
+        std::string Key(uint32_t id) const {
+            std::string out{};
+            Key(id, out);
+            return out;
+        }
+
+        /*
+         * Iterate over the keys starting with a prefix in lexicographic order
+         * @param prefix prefix
+         * @param func callback (std::string_view key, uint32_t id), can return false to stop the iteration
+         */
+        template<typename Func>
+        void ForEachPrefix(std::string_view prefix, Func&& func) const {
+            uint32_t root = FindNode(prefix);
+            if (root == npos) {
+                return;
+            }
+
+            struct Frame {
+                uint32_t child;
+                uint32_t end;
+            };
+            std::string key{ prefix };
+            std::vector<Frame> stack{};
+
+            auto visit = [&](uint32_t node) -> bool {
+                if (terminals.Get(node)) {
+                    if constexpr (std::is_convertible_v<std::invoke_result_t<Func, std::string_view, uint32_t>, bool>) {
+                        if (!func(std::string_view{ key }, (uint32_t)terminals.Rank1(node))) {
+                            return false;
+                        }
+                    } else {
+                        func(std::string_view{ key }, (uint32_t)terminals.Rank1(node));
+                    }
+                }
+                auto [first, degree] = Children(node);
+                stack.emplace_back(first, first + degree);
+                return true;
+            };
+
+            if (!visit(root)) {
+                return;
+            }
+            while (!stack.empty()) {
+                Frame& top = stack.back();
+                if (top.child == top.end) {
+                    stack.pop_back();
+                    if (!stack.empty()) {
+                        key.pop_back();
+                    }
+                    continue;
+                }
+                uint32_t child = top.child++;
+                key.push_back((char)labels[child - 1]);
+                if (!visit(child)) {
+                    return;
+                }
+            }
+        }
+
+    private:
+        std::pair<uint32_t, uint32_t> Children(uint32_t node) const {
+            uint64_t start = node ? louds.Select0(node - 1) + 1 : 0;
+            uint64_t end = louds.NextZero(start);
+            // ones before start are the children of the previous nodes, the node k is the (k - 1)-th one
+            return std::make_pair((uint32_t)(start - node + 1), (uint32_t)(end - start));
+        }
+
+        uint32_t FindNode(std::string_view key) const {
+            if (!node_count) {
+                return npos;
+            }
+            uint32_t node = 0;
+            for (char c : key) {
+                auto [first, degree] = Children(node);
+                const uint8_t* begin = labels + first - 1;
+                const uint8_t* end = begin + degree;
+                const uint8_t* it = std::lower_bound(begin, end, (uint8_t)c);
+                if (it == end || *it != (uint8_t)c) {
+                    return npos;
+                }
+                node = first + (uint32_t)(it - begin);
+            }
+            return node;
+        }
+    };
+
+    /*
+     * Create the blocks of a bit vector and link them into a struct.
+     * @param builder builder
+     * @param owner block containing the DB_BIT_VECTOR
+     * @param offset offset of the DB_BIT_VECTOR in the owner block
+     * @param words bits
+     * @param size bit count
+     */
+    inline void CreateBitVector(DBFileBuilder& builder, BlockId owner, BlockOffset offset, const std::vector<uint64_t>& words, uint64_t size) {
+        uint64_t blocks = (size + DB_BIT_VECTOR_RANK_BLOCK - 1) / DB_BIT_VECTOR_RANK_BLOCK;
+        std::vector<uint32_t> ranks{};
+        ranks.reserve(blocks + 1);
+        uint32_t r = 0;
+        for (size_t w = 0; w < words.size(); w++) {
+            if (w % (DB_BIT_VECTOR_RANK_BLOCK / 64) == 0) {
+                ranks.push_back(r);
+            }
+            r += std::popcount(words[w]);
+        }
+        ranks.resize(blocks + 1, r);
+
+        // always write at least one word to have a valid pointer
+        std::vector<uint64_t> data{ words };
+        data.push_back(0);
+
+        builder.AlignBlock();
+        BlockId bitsId = builder.CreateBlock(data.data(), data.size() * sizeof(data[0]));
+        BlockId ranksId = builder.CreateBlock(ranks.data(), ranks.size() * sizeof(ranks[0]));
+
+        *reinterpret_cast<uint64_t*>(builder.GetBlock<uint8_t>(owner) + offset + offsetof(DB_BIT_VECTOR, size)) = size;
+        builder.CreateLink(owner, offset + offsetof(DB_BIT_VECTOR, bits), bitsId);
+        builder.CreateLink(owner, offset + offsetof(DB_BIT_VECTOR, ranks), ranksId);
+    }
+
+    /*
+     * Create a LOUDS trie from a sorted key set.
+     * @param builder builder
+     * @param keys sorted and unique keys, the elements should be convertible to std::string_view
+     * @return block id of the DB_TRIE
+     */
+    template<typename Keys>
+    BlockId CreateTrie(DBFileBuilder& builder, const Keys& keys) {
+        std::vector<std::string_view> sorted{};
+        for (const auto& key : keys) {
+            std::string_view k{ key };
+            if (!sorted.empty() && sorted.back() >= k) {
+                DBFLIB_THROW("trie keys should be sorted and unique");
+            }
+            sorted.push_back(k);
+        }
+        if (sorted.size() >= DB_TRIE::npos) {
+            DBFLIB_THROW("too many trie keys");
+        }
+
+        std::vector<uint64_t> louds{};
+        std::vector<uint64_t> terminals{};
+        std::vector<uint8_t> labels{};
+        uint64_t loudsSize{};
+        uint64_t nodeCount{};
+
+        auto push = [](std::vector<uint64_t>& words, uint64_t& size, bool bit) {
+            if ((size & 63) == 0) {
+                words.push_back(0);
+            }
+            if (bit) {
+                words.back() |= 1ull << (size & 63);
+            }
+            size++;
+        };
+
+        struct Range {
+            size_t lo;
+            size_t hi;
+            size_t depth;
+        };
+        std::vector<Range> queue{};
+        queue.emplace_back(0, sorted.size(), 0);
+
+        for (size_t q = 0; q < queue.size(); q++) {
+            // copy, the queue can grow
+            Range r = queue[q];
+            bool terminal = r.lo < r.hi && sorted[r.lo].size() == r.depth;
+            push(terminals, nodeCount, terminal);
+
+            size_t k = r.lo + (terminal ? 1 : 0);
+            while (k < r.hi) {
+                uint8_t c = (uint8_t)sorted[k][r.depth];
+                size_t j = k + 1;
+                while (j < r.hi && (uint8_t)sorted[j][r.depth] == c) {
+                    j++;
+                }
+                push(louds, loudsSize, true);
+                labels.push_back(c);
+                queue.emplace_back(k, j, r.depth + 1);
+                k = j;
+            }
+            push(louds, loudsSize, false);
+        }
+
+        if (nodeCount >= UINT32_MAX) {
+            DBFLIB_THROW("too many trie nodes");
+        }
+
+        builder.AlignBlock();
+        auto [trieId, trie] = builder.CreateBlock<DB_TRIE>();
+        trie->key_count = (uint32_t)sorted.size();
+        trie->node_count = (uint32_t)nodeCount;
+
+        CreateBitVector(builder, trieId, offsetof(DB_TRIE, louds), louds, loudsSize);
+        CreateBitVector(builder, trieId, offsetof(DB_TRIE, terminals), terminals, nodeCount);
+
+        // keep a valid pointer for the trie without labels
+        labels.push_back(0);
+        BlockId labelsId = builder.CreateBlock(labels.data(), labels.size());
+        builder.CreateLink(trieId, offsetof(DB_TRIE, labels), labelsId);
+
+        return trieId;
+    }
+}
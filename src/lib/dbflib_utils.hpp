@@ -0,0 +1,229 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+#if defined(__AVX2__)
+#define DBFLIB_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(DBFLIB_AVX2)
+#define DBFLIB_SSE2
+#endif
+
+#if defined(DBFLIB_AVX2) || defined(DBFLIB_SSE2)
+#include <immintrin.h>
+#endif
+
+/*
+ * Encoding utilities shared by the block types
+ */
+namespace dbflib::utils {
+    /*
+     * Compute the length of the common prefix of 2 buffers
+     * @param a first buffer
+     * @param b second buffer
+     * @param len max length to compare
+     * @return common prefix length
+     */
+    inline size_t CommonPrefixLength(const void* a, const void* b, size_t len) {
+        const uint8_t* pa = reinterpret_cast<const uint8_t*>(a);
+        const uint8_t* pb = reinterpret_cast<const uint8_t*>(b);
+        size_t i = 0;
+#ifdef DBFLIB_AVX2
+        for (; i + 32 <= len; i += 32) {
+            __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pa + i));
+            __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pb + i));
+            uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb));
+            if (mask != UINT32_MAX) {
+                return i + std::countr_zero(~mask);
+            }
+        }
+#endif
+#ifdef DBFLIB_SSE2
+        for (; i + 16 <= len; i += 16) {
+            __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pa + i));
+            __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pb + i));
+            uint32_t mask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb));
+            if (mask != 0xFFFF) {
+                return i + std::countr_zero(~mask);
+            }
+        }
+#endif
+        while (i < len && pa[i] == pb[i]) {
+            i++;
+        }
+        return i;
+    }
+
+    /*
+     * Find the first occurrence of one of 3 bytes
+     * @param begin buffer start
+     * @param end buffer end
+     * @param a first byte
+     * @param b second byte
+     * @param c third byte
+     * @return pointer to the first occurrence, end if not found
+     */
+    inline const char* FindAnyOf(const char* begin, const char* end, char a, char b, char c) {
+        const char* p = begin;
+#ifdef DBFLIB_AVX2
+        {
+            __m256i va = _mm256_set1_epi8(a);
+            __m256i vb = _mm256_set1_epi8(b);
+            __m256i vc = _mm256_set1_epi8(c);
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                __m256i eq = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, va), _mm256_cmpeq_epi8(v, vb)), _mm256_cmpeq_epi8(v, vc));
+                uint32_t mask = (uint32_t)_mm256_movemask_epi8(eq);
+                if (mask) {
+                    return p + std::countr_zero(mask);
+                }
+            }
+        }
+#endif
+#ifdef DBFLIB_SSE2
+        {
+            __m128i va = _mm_set1_epi8(a);
+            __m128i vb = _mm_set1_epi8(b);
+            __m128i vc = _mm_set1_epi8(c);
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, va), _mm_cmpeq_epi8(v, vb)), _mm_cmpeq_epi8(v, vc));
+                uint32_t mask = (uint32_t)_mm_movemask_epi8(eq);
+                if (mask) {
+                    return p + std::countr_zero(mask);
+                }
+            }
+        }
+#endif
+        for (; p < end; p++) {
+            if (*p == a || *p == b || *p == c) {
+                return p;
+            }
+        }
+        return end;
+    }
+
+    /*
+     * Find the first occurrence of a byte
+     * @param begin buffer start
+     * @param end buffer end
+     * @param c byte
+     * @return pointer to the first occurrence, end if not found
+     */
+    inline const char* FindByte(const char* begin, const char* end, char c) {
+        return FindAnyOf(begin, end, c, c, c);
+    }
+
+    /*
+     * Count the occurrences of a byte
+     * @param begin buffer start
+     * @param end buffer end
+     * @param c byte
+     * @return count
+     */
+    inline size_t CountByte(const char* begin, const char* end, char c) {
+        const char* p = begin;
+        size_t count = 0;
+#ifdef DBFLIB_AVX2
+        {
+            __m256i vc = _mm256_set1_epi8(c);
+            for (; end - p >= 32; p += 32) {
+                __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                count += std::popcount((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, vc)));
+            }
+        }
+#endif
+#ifdef DBFLIB_SSE2
+        {
+            __m128i vc = _mm_set1_epi8(c);
+            for (; end - p >= 16; p += 16) {
+                __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                count += std::popcount((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, vc)));
+            }
+        }
+#endif
+        for (; p < end; p++) {
+            count += *p == c;
+        }
+        return count;
+    }
+
+    /*
+     * Write a LEB128 variable length integer
+     * @param out output buffer
+     * @param value value
+     */
+    inline void WriteVarInt(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((uint8_t)value);
+    }
+
+    /*
+     * Read a LEB128 variable length integer
+     * @param ptr buffer pointer, moved after the integer
+     * @return value
+     */
+    inline uint64_t ReadVarInt(const uint8_t*& ptr) {
+        uint64_t value = *ptr & 0x7F;
+        uint32_t shift = 7;
+        while (*ptr++ & 0x80) {
+            value |= (uint64_t)(*ptr & 0x7F) << shift;
+            shift += 7;
+        }
+        return value;
+    }
+
+    /*
+     * Mix the bits of a 64 bits value, splitmix64 finalizer
+     * @param x value
+     * @return mixed value
+     */
+    constexpr uint64_t Mix64(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    /*
+     * Hash a buffer, the filters stored in the files depend on this function, it should never change
+     * @param buffer buffer
+     * @param len buffer size
+     * @param seed hash seed
+     * @return 64 bits hash
+     */
+    inline uint64_t Hash64(const void* buffer, size_t len, uint64_t seed = 0) {
+        const uint8_t* ptr = reinterpret_cast<const uint8_t*>(buffer);
+        uint64_t h = Mix64(seed ^ (len * 0x9e3779b97f4a7c15ull));
+        for (; len >= 8; len -= 8, ptr += 8) {
+            uint64_t k;
+            std::memcpy(&k, ptr, sizeof(k));
+            h = Mix64(h ^ k) + 0x9e3779b97f4a7c15ull;
+        }
+        if (len) {
+            uint64_t k{};
+            std::memcpy(&k, ptr, len);
+            h = Mix64(h ^ k ^ ((uint64_t)len << 56));
+        }
+        return Mix64(h);
+    }
+
+    /*
+     * Hash a string
+     * @param str string
+     * @param seed hash seed
+     * @return 64 bits hash
+     */
+    inline uint64_t Hash64(std::string_view str, uint64_t seed = 0) {
+        return Hash64(str.data(), str.size(), seed);
+    }
+}
@@ -1,4 +1,5 @@
 #include <dbflib.hpp>
+#include <tests.hpp>
 #include <iostream>
 #include <assert.h>
 
@@ -76,5 +77,30 @@ int main(int argc, char const *argv[]) {
 
     std::filesystem::remove(tmp);
 
+    TestTrie();
+    TestFrontCoded();
+    TestPackedArray();
+    TestBloomFilter();
+    TestCsrGraph();
+    TestHnsw();
+    TestRTree();
+    TestTimeSeries();
+    TestDictionaryColumn();
+    TestBlockView();
+    TestWriteTo();
+    TestConcurrentBuilder();
+    TestExecutor();
+    TestReaderOptions();
+    TestProgressiveLoader();
+    TestExpected();
+    TestShardedFile();
+    TestIngest();
+    TestArrow();
+    TestSubgraph();
+    TestBlockTypes();
+    TestSparse();
+    TestSymbols();
+    TestRing();
+
     return 0;
 }
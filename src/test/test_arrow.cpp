@@ -0,0 +1,116 @@
+#include <dbflib_arrow.hpp>
+#include <tests.hpp>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    bool InFile(const void* ptr, dbflib::DB_FILE* file) {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(ptr);
+        return p >= file->magic && p < file->magic + file->file_size;
+    }
+
+    bool Bit(const void* bitmap, size_t id) {
+        return (reinterpret_cast<const uint8_t*>(bitmap)[id >> 3] >> (id & 7)) & 1;
+    }
+}
+
+void TestArrow() {
+    constexpr size_t count = 1000;
+    std::vector<int32_t> ids(count);
+    std::vector<double> scores(count);
+    std::vector<uint8_t> levels(count);
+    std::unique_ptr<bool[]> flags = std::make_unique<bool[]>(count);
+    std::unique_ptr<bool[]> valid = std::make_unique<bool[]>(count);
+    std::vector<std::string> names(count);
+    std::vector<std::string_view> nameViews(count);
+    for (size_t i = 0; i < count; i++) {
+        ids[i] = (int32_t)i - 500;
+        scores[i] = (double)i * 1.5;
+        levels[i] = (uint8_t)(i % 7);
+        flags[i] = i % 3 == 0;
+        valid[i] = i % 5 != 0;
+        names[i] = "name" + std::to_string(i * 31);
+        nameViews[i] = names[i];
+    }
+
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+    dbflib::DBArrowTableBuilder table{ builder, count };
+    table.AddColumn("id", ids.data());
+    table.AddColumn("score", scores.data(), valid.get());
+    table.AddColumn("level", levels.data());
+    table.AddBoolColumn("flag", flags.get());
+    table.AddStringColumn("name", nameViews.data(), valid.get());
+    table.Build();
+
+    std::filesystem::path tmp{ std::filesystem::temp_directory_path() / "dbflib_arrow.dbf" };
+    builder.WriteToFile(tmp);
+
+    ArrowArray array{};
+    ArrowSchema schema{};
+    std::weak_ptr<dbflib::DBFileReader> weakReader{};
+    dbflib::DB_FILE* file;
+    {
+        std::shared_ptr<dbflib::DBFileReader> reader = std::make_shared<dbflib::DBFileReader>(tmp, dbflib::DBFRO_MMAP);
+        weakReader = reader;
+        file = reader->GetFile();
+        dbflib::DB_ARROW_TABLE* t = reader->GetStart<dbflib::DB_ARROW_TABLE>();
+        assert(t->length == count && t->column_count == 5 && "Bad arrow table");
+        dbflib::DB_ARROW_COLUMN* score = t->FindColumn("score");
+        assert(score && score->type == dbflib::DBAT_DOUBLE && score->null_count == count / 5 && "Bad arrow column");
+        assert(!t->FindColumn("id")->validity && "Unexpected arrow validity");
+        assert(t->FindColumn("name")->String(42) == names[42] && "Bad arrow string");
+        assert(!t->FindColumn("name")->IsValid(40) && t->FindColumn("name")->IsValid(41) && "Bad arrow validity");
+
+        dbflib::DBArrowExporter::ExportTable(*t, &array, &schema, reader);
+    }
+    // the exported structures are keeping the file alive
+    assert(!weakReader.expired() && "Arrow owner released");
+
+    assert(std::string_view{ schema.format } == "+s" && schema.n_children == 5 && "Bad arrow struct schema");
+    assert(array.length == count && array.n_children == 5 && array.n_buffers == 1 && "Bad arrow struct array");
+    const char* formats[]{ "i", "g", "C", "b", "u" };
+    const char* columnNames[]{ "id", "score", "level", "flag", "name" };
+    for (size_t c = 0; c < 5; c++) {
+        ArrowSchema* child = schema.children[c];
+        assert(std::string_view{ child->format } == formats[c] && "Bad arrow format");
+        assert(std::string_view{ child->name } == columnNames[c] && "Bad arrow name");
+        assert(array.children[c]->length == count && "Bad arrow column length");
+        for (int64_t b = 0; b < array.children[c]->n_buffers; b++) {
+            const void* buffer = array.children[c]->buffers[b];
+            assert((!buffer || InFile(buffer, file)) && "Arrow buffer not in the file");
+            assert(((uintptr_t)buffer % dbflib::DB_ARROW_ALIGNMENT) == 0 && "Arrow buffer not aligned");
+        }
+    }
+
+    const int32_t* idValues = reinterpret_cast<const int32_t*>(array.children[0]->buffers[1]);
+    const double* scoreValues = reinterpret_cast<const double*>(array.children[1]->buffers[1]);
+    const void* scoreValidity = array.children[1]->buffers[0];
+    const uint8_t* levelValues = reinterpret_cast<const uint8_t*>(array.children[2]->buffers[1]);
+    const void* flagValues = array.children[3]->buffers[1];
+    const int32_t* nameOffsets = reinterpret_cast<const int32_t*>(array.children[4]->buffers[1]);
+    const char* nameValues = reinterpret_cast<const char*>(array.children[4]->buffers[2]);
+    assert(array.children[1]->null_count == count / 5 && array.children[4]->null_count == count / 5 && "Bad arrow null count");
+    for (size_t i = 0; i < count; i++) {
+        assert(idValues[i] == ids[i] && "Bad arrow int32");
+        assert(Bit(scoreValidity, i) == valid[i] && "Bad arrow validity bitmap");
+        assert((!valid[i] || scoreValues[i] == scores[i]) && "Bad arrow double");
+        assert(levelValues[i] == levels[i] && "Bad arrow uint8");
+        assert(Bit(flagValues, i) == flags[i] && "Bad arrow bool");
+        std::string_view name{ nameValues + nameOffsets[i], (size_t)(nameOffsets[i + 1] - nameOffsets[i]) };
+        assert(name == names[i] && "Bad arrow utf8");
+    }
+
+    // a consumer can move a child out and release it separately
+    ArrowArray moved = *array.children[4];
+    array.children[4]->release = nullptr;
+    array.release(&array);
+    assert(!array.release && "Arrow array not released");
+    assert(!weakReader.expired() && "Arrow owner released with a moved child");
+    moved.release(&moved);
+    schema.release(&schema);
+    assert(!schema.release && "Arrow schema not released");
+    assert(weakReader.expired() && "Arrow owner not released");
+
+    std::filesystem::remove(tmp);
+    std::cout << "ok for arrow\n";
+}
@@ -0,0 +1,86 @@
+#include <dbflib.hpp>
+#include <tests.hpp>
+#include <atomic>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    enum BlockTypeTag : uint32_t {
+        BTT_USER = 1,
+        BTT_ORDER,
+        BTT_UNUSED,
+    };
+
+    struct TypedUser {
+        uint64_t id;
+        TypedUser* next;
+    };
+
+    struct TypedOrder {
+        uint64_t user;
+        uint64_t amount;
+    };
+}
+
+void TestBlockTypes() {
+    constexpr size_t users = 3000;
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN | dbflib::DBFBO_BLOCK_TABLE };
+    auto [rootId, root] = builder.CreateBlock<uint64_t>();
+    *root = users;
+    dbflib::BlockId prev{};
+    uint64_t expectedAmount{};
+    for (size_t i = 0; i < users; i++) {
+        auto [userId, user] = builder.CreateBlock<TypedUser>();
+        user->id = i;
+        builder.SetBlockType(userId, BTT_USER);
+        if (prev) {
+            builder.CreateLink(userId, offsetof(TypedUser, next), prev);
+        }
+        prev = userId;
+        for (size_t j = 0; j < i % 3; j++) {
+            auto [orderId, order] = builder.CreateBlock<TypedOrder>();
+            order->user = i;
+            order->amount = i * 10 + j;
+            expectedAmount += order->amount;
+            builder.SetBlockType(orderId, BTT_ORDER);
+        }
+        // untyped padding block
+        builder.CreateBlock<uint64_t>(i % 5 * 8 + 8);
+    }
+    builder.SetBlockType(rootId, BTT_UNUSED);
+    builder.SetBlockType(rootId, 0);
+
+    dbflib::DB_FILE* file = builder.Build();
+    file->Validate();
+    file->Link();
+
+    std::span<const dbflib::DB_FILE_BLOCK> userBlocks = file->GetBlocksOfType(BTT_USER);
+    assert(userBlocks.size() == users && "Bad typed block count");
+    for (size_t i = 0; i < userBlocks.size(); i++) {
+        assert(userBlocks[i].size == sizeof(TypedUser) && "Bad typed block size");
+        assert((!i || userBlocks[i - 1].offset < userBlocks[i].offset) && "Typed blocks not sorted");
+        assert(reinterpret_cast<TypedUser*>(file->magic + userBlocks[i].offset)->id == i && "Bad typed block");
+    }
+    assert(file->GetBlocksOfType(BTT_ORDER).size() == users && "Bad typed block count");
+    assert(file->GetBlocksOfType(BTT_UNUSED).empty() && "Untyped block listed");
+
+    dbflib::DBWorkStealingExecutor executor{ 3 };
+    std::atomic<uint64_t> amount{};
+    std::atomic<size_t> orders{};
+    file->ForEachBlockOfType<TypedOrder>(BTT_ORDER, [&amount, &orders](TypedOrder* order, size_t size) {
+        assert(size == sizeof(TypedOrder) && order->amount / 10 == order->user && "Bad typed order");
+        amount.fetch_add(order->amount, std::memory_order_relaxed);
+        orders.fetch_add(1, std::memory_order_relaxed);
+    }, executor, 16);
+    assert(orders == users && amount == expectedAmount && "Bad typed iteration");
+
+    size_t linkedUsers = 0;
+    dbflib::DBSerialExecutor serial{};
+    file->ForEachBlockOfType<TypedUser>(BTT_USER, [&linkedUsers](TypedUser* user, size_t) {
+        assert((!user->id || user->next->id == user->id - 1) && "Bad typed user link");
+        linkedUsers++;
+    }, serial);
+    assert(linkedUsers == users && "Bad typed serial iteration");
+
+    std::cout << "ok for block types\n";
+}
@@ -0,0 +1,70 @@
+#include <dbflib.hpp>
+#include <tests.hpp>
+#include <cstring>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    struct BlockViewRoot {
+        uint64_t size;
+        uint8_t* payload;
+        uint32_t* tail;
+        uint8_t* view;
+        uint64_t* after;
+    };
+
+    void ValidateBlockView(const BlockViewRoot* root, const std::vector<uint8_t>& payload) {
+        assert(root->size == payload.size() && "Bad block view size");
+        assert(!std::memcmp(root->payload, payload.data(), payload.size()) && "Bad block view payload");
+        assert(root->tail[0] == 42 && root->tail[1] == 43 && "Bad block after a view");
+        assert(!std::memcmp(root->view, root->tail, 3) && *root->after == 44 && "Bad block after two views");
+    }
+}
+
+void TestBlockView() {
+    std::vector<uint8_t> payload(100003);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = (uint8_t)(i * 31 + 7);
+    }
+    uint32_t tail[]{ 42, 43 };
+    std::filesystem::path tmp{ std::filesystem::temp_directory_path() / "dbflib_block_view.dbf" };
+
+    for (bool write : { false, true }) {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        auto [rootId, root] = builder.CreateBlock<BlockViewRoot>();
+        root->size = payload.size();
+        dbflib::BlockId payloadId = builder.CreateBlockView(payload.data(), payload.size());
+        assert(builder.GetBlock<uint8_t>(payloadId) == payload.data() && "View block not referencing the buffer");
+        assert(builder.GetBlockSize(payloadId) == payload.size() && "Bad view block size");
+        dbflib::BlockId tailId = builder.CreateBlock(tail, sizeof(tail));
+        assert(tailId % 8 == 0 && "Block after a view not aligned");
+        assert(reinterpret_cast<uintptr_t>(builder.GetBlock<uint32_t>(tailId)) % 8 == 0 && "Block pointer after a view not aligned");
+        // second view right after the first one
+        dbflib::BlockId viewId = builder.CreateBlockView(tail, 3);
+        auto [afterId, after] = builder.CreateBlock<uint64_t>();
+        assert(reinterpret_cast<uintptr_t>(after) % 8 == 0 && after == builder.GetBlock<uint64_t>(afterId) && "Block pointer after views not aligned");
+        *after = 44;
+        assert(builder.GetBlock<uint32_t>(tailId)[1] == 43 && "Bad block after a view");
+        builder.GetBlock<uint32_t>(tailId)[0] = 42;
+        // empty view
+        builder.CreateBlockView(nullptr, 0);
+        builder.CreateLink(rootId, offsetof(BlockViewRoot, payload), payloadId);
+        builder.CreateLink(rootId, offsetof(BlockViewRoot, tail), tailId);
+        builder.CreateLink(rootId, offsetof(BlockViewRoot, view), viewId);
+        builder.CreateLink(rootId, offsetof(BlockViewRoot, after), afterId);
+
+        if (!write) {
+            dbflib::DB_FILE* file = builder.Build();
+            file->Validate();
+            file->Link();
+            ValidateBlockView(file->Start<BlockViewRoot>(), payload);
+            continue;
+        }
+        builder.WriteToFile(tmp);
+        dbflib::DBFileReader reader{ tmp };
+        ValidateBlockView(reader.GetStart<BlockViewRoot>(), payload);
+    }
+    std::filesystem::remove(tmp);
+
+    std::cout << "ok for block view\n";
+}
@@ -0,0 +1,42 @@
+#include <dbflib_bloom.hpp>
+#include <tests.hpp>
+#include <string>
+#include <assert.h>
+
+void TestBloomFilter() {
+    std::vector<std::string> keys{};
+    for (int i = 0; i < 20000; i++) {
+        keys.push_back("user:" + std::to_string(i));
+    }
+    std::vector<uint64_t> ids{};
+    for (uint64_t i = 0; i < 20000; i++) {
+        ids.push_back(i * 3);
+    }
+
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+    dbflib::CreateBloomFilter(builder, keys, 10, 42);
+    dbflib::BlockId idsId = dbflib::CreateBloomFilter(builder, ids);
+    dbflib::DB_FILE* file = builder.Build();
+    file->Link();
+
+    const dbflib::DB_BLOOM_FILTER* filter = file->Start<dbflib::DB_BLOOM_FILTER>();
+    const dbflib::DB_BLOOM_FILTER* idsFilter = reinterpret_cast<dbflib::DB_BLOOM_FILTER*>(file->magic + idsId);
+
+    for (const std::string& key : keys) {
+        assert(filter->MayContain(key) && "Bloom filter false negative");
+    }
+    for (uint64_t id : ids) {
+        assert(idsFilter->MayContain(id) && "Bloom filter false negative");
+    }
+
+    size_t falsePositives{};
+    size_t idsFalsePositives{};
+    for (int i = 0; i < 20000; i++) {
+        falsePositives += filter->MayContain("absent:" + std::to_string(i));
+        idsFalsePositives += idsFilter->MayContain((uint64_t)i * 3 + 1);
+    }
+    assert(falsePositives < 20000 * 3 / 100 && "Bloom filter has too many false positives");
+    assert(idsFalsePositives < 20000 * 3 / 100 && "Bloom filter has too many false positives");
+
+    std::cout << "ok for bloom filter\n";
+}
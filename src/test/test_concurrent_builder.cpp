@@ -0,0 +1,107 @@
+#include <dbflib_concurrent.hpp>
+#include <tests.hpp>
+#include <cstring>
+#include <thread>
+#include <assert.h>
+
+namespace {
+    struct ConcurrentRecord {
+        uint64_t value;
+        ConcurrentRecord* next;
+    };
+
+    struct ConcurrentRoot {
+        uint64_t count;
+        ConcurrentRecord* heads[4];
+    };
+}
+
+void TestConcurrentBuilder() {
+    constexpr size_t threads = 4;
+    constexpr size_t records = 10000;
+    dbflib::DBConcurrentFileBuilder builder{ 1 << 20, dbflib::DBFBO_ALIGN };
+
+    auto [rootId, root] = builder.CreateBlock<ConcurrentRoot>();
+    root->count = threads;
+    builder.SetStart(rootId);
+
+    dbflib::BlockId heads[threads]{};
+    std::vector<std::thread> pool{};
+    for (size_t t = 0; t < threads; t++) {
+        pool.emplace_back([&builder, &heads, t]() {
+            dbflib::DBConcurrentFileBuilder::Producer producer = builder.CreateProducer();
+            dbflib::BlockId prev{};
+            for (size_t i = 0; i < records; i++) {
+                ConcurrentRecord record{ t * records + i, nullptr };
+                dbflib::BlockId id = producer.CreateBlock(&record, sizeof(record));
+                if (i) {
+                    producer.CreateLink(id, offsetof(ConcurrentRecord, next), prev);
+                }
+                prev = id;
+            }
+            heads[t] = prev;
+        });
+    }
+    for (std::thread& t : pool) {
+        t.join();
+    }
+    dbflib::DBConcurrentFileBuilder::Producer producer = builder.CreateProducer();
+    for (size_t t = 0; t < threads; t++) {
+        producer.CreateLink(rootId, (dbflib::BlockOffset)(offsetof(ConcurrentRoot, heads) + t * sizeof(ConcurrentRecord*)), heads[t]);
+    }
+
+    dbflib::DB_FILE* file = builder.Build();
+    file->Validate();
+    file->Link();
+    assert(file->links_count == threads * records && "Bad concurrent links count");
+    ConcurrentRoot* r = file->Start<ConcurrentRoot>();
+    assert(r->count == threads && "Bad concurrent root");
+    for (size_t t = 0; t < threads; t++) {
+        size_t count = 0;
+        uint64_t expected = (t + 1) * records;
+        for (ConcurrentRecord* record = r->heads[t]; record; record = record->next) {
+            assert(reinterpret_cast<uintptr_t>(record) % 8 == 0 && "Concurrent block not aligned");
+            assert(record->value == --expected && "Bad concurrent record");
+            count++;
+        }
+        assert(count == records && "Bad concurrent record count");
+    }
+
+    // small block, only the build guard can reject it
+    bool built = false;
+    try {
+        builder.CreateBlock<uint64_t>();
+    } catch (std::runtime_error& e) {
+        built = !std::strcmp(e.what(), "file already linked");
+    }
+    assert(built && "Block created after build");
+
+    {
+        // a rejected block doesn't consume the region
+        dbflib::DBConcurrentFileBuilder small{ 0x1000, dbflib::DBFBO_ALIGN };
+        bool full = false;
+        try {
+            small.CreateBlock<uint8_t>(0x2000);
+        } catch (std::runtime_error& e) {
+            full = !std::strcmp(e.what(), "concurrent builder region full");
+        }
+        assert(full && "Block bigger than the region created");
+        auto [firstId, first] = small.CreateBlock<ConcurrentRecord>();
+        auto [secondId, second] = small.CreateBlock<uint8_t>(0x1000 - sizeof(dbflib::DB_FILE) - sizeof(ConcurrentRecord));
+        assert(first && second && "Block fitting the region rejected");
+        small.CreateProducer().CreateLink(firstId, offsetof(ConcurrentRecord, next), secondId);
+
+        // no room for the links table, the failed build can be retried
+        for (size_t i = 0; i < 2; i++) {
+            bool buildFull = false;
+            try {
+                small.Build();
+            } catch (std::runtime_error& e) {
+                buildFull = !std::strcmp(e.what(), "concurrent builder region full");
+            }
+            assert(buildFull && "File built without its links table");
+        }
+    }
+
+    std::cout << "ok for concurrent builder\n";
+}
@@ -0,0 +1,68 @@
+#include <dbflib_csr_graph.hpp>
+#include <tests.hpp>
+#include <queue>
+#include <random>
+#include <assert.h>
+
+void TestCsrGraph() {
+    constexpr uint32_t nodeCount = 20000;
+    std::mt19937 rnd{ 42 };
+    std::vector<std::pair<uint32_t, uint32_t>> edges{};
+    std::vector<std::vector<uint32_t>> adjacency(nodeCount);
+    for (uint32_t i = 0; i < nodeCount * 4; i++) {
+        uint32_t a = rnd() % nodeCount;
+        uint32_t b = (a + 1 + rnd() % 100) % nodeCount;
+        edges.emplace_back(a, b);
+        adjacency[a].push_back(b);
+    }
+    for (std::vector<uint32_t>& n : adjacency) {
+        std::sort(n.begin(), n.end());
+    }
+
+    // reference distances
+    std::vector<uint32_t> expected(nodeCount, dbflib::DB_CSR_GRAPH_UNREACHED);
+    std::queue<uint32_t> queue{};
+    expected[0] = 0;
+    queue.push(0);
+    while (!queue.empty()) {
+        uint32_t node = queue.front();
+        queue.pop();
+        for (uint32_t n : adjacency[node]) {
+            if (expected[n] == dbflib::DB_CSR_GRAPH_UNREACHED) {
+                expected[n] = expected[node] + 1;
+                queue.push(n);
+            }
+        }
+    }
+
+    for (bool compress : { false, true }) {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::CreateCsrGraph(builder, nodeCount, edges, compress);
+        dbflib::DB_FILE* file = builder.Build();
+        file->Link();
+        const dbflib::DB_CSR_GRAPH* graph = file->Start<dbflib::DB_CSR_GRAPH>();
+
+        assert(graph->node_count == nodeCount && graph->edge_count == edges.size() && "Bad graph size");
+        assert(graph->IsCompressed() == compress && "Bad graph flags");
+        if (compress) {
+            assert(file->file_size < edges.size() * sizeof(uint32_t) && "Graph not compressed");
+        }
+        for (uint32_t node = 0; node < nodeCount; node++) {
+            assert(graph->Degree(node) == adjacency[node].size() && "Bad graph degree");
+            std::vector<uint32_t> neighbors{};
+            graph->ForEachNeighbor(node, [&neighbors](uint32_t n) { neighbors.push_back(n); });
+            assert(neighbors == adjacency[node] && "Bad graph neighbors");
+            if (!compress) {
+                auto span = graph->Neighbors(node);
+                assert(std::equal(span.begin(), span.end(), adjacency[node].begin(), adjacency[node].end()) && "Bad graph neighbors");
+            }
+        }
+
+        dbflib::DBSerialExecutor serial{};
+        dbflib::DBWorkStealingExecutor pool{ 3 };
+        assert(graph->BreadthFirstSearch(0, serial) == expected && "Bad graph traversal");
+        assert(graph->BreadthFirstSearch(0, pool, 16) == expected && "Bad parallel graph traversal");
+    }
+
+    std::cout << "ok for csr graph\n";
+}
@@ -0,0 +1,53 @@
+#include <dbflib_dictionary.hpp>
+#include <tests.hpp>
+#include <random>
+#include <string>
+#include <assert.h>
+
+void TestDictionaryColumn() {
+    std::mt19937 rnd{ 42 };
+
+    for (size_t cardinality : { 1, 5, 256, 300, 70000 }) {
+        std::vector<std::string> values(cardinality);
+        for (size_t i = 0; i < cardinality; i++) {
+            values[i] = (i % 3 ? "status-" : "country-") + std::to_string(i);
+        }
+        std::vector<std::string> rows(100003);
+        for (size_t i = 0; i < rows.size(); i++) {
+            rows[i] = values[i < cardinality ? i : rnd() % cardinality];
+        }
+
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::CreateDictionaryColumn(builder, rows);
+        dbflib::DB_FILE* file = builder.Build();
+        file->Link();
+        const dbflib::DB_DICTIONARY_COLUMN* column = file->Start<dbflib::DB_DICTIONARY_COLUMN>();
+
+        assert(column->row_count == rows.size() && column->dictionary_size == cardinality && "Bad dictionary column size");
+        assert(column->code_width == (cardinality <= 256 ? 1u : cardinality <= 65536 ? 2u : 4u) && "Bad dictionary code width");
+        for (size_t i = 0; i < rows.size(); i++) {
+            assert((*column)[i] == rows[i] && "Bad dictionary column value");
+        }
+        assert(column->Find("unknown") == dbflib::DB_DICTIONARY_COLUMN::npos && "Unknown value found");
+
+        const std::string& target = values[cardinality / 2];
+        std::vector<uint64_t> bitmap = column->FilterEquals(target);
+        for (size_t i = 0; i < rows.size(); i++) {
+            bool set = (bitmap[i / 64] >> (i % 64)) & 1;
+            assert(set == (rows[i] == target) && "Bad dictionary equality filter");
+        }
+
+        auto [first, end] = column->FindPrefix("country-");
+        size_t count = column->Filter(first, end, bitmap.data());
+        size_t expected{};
+        for (size_t i = 0; i < rows.size(); i++) {
+            bool match = rows[i].starts_with("country-");
+            expected += match;
+            assert((((bitmap[i / 64] >> (i % 64)) & 1) != 0) == match && "Bad dictionary range filter");
+        }
+        assert(count == expected && "Bad dictionary filter count");
+        assert(column->Filter(0, column->dictionary_size, bitmap.data()) == rows.size() && "Bad dictionary full filter");
+    }
+
+    std::cout << "ok for dictionary column\n";
+}
@@ -0,0 +1,123 @@
+#include <dbflib.hpp>
+#include <tests.hpp>
+#include <numeric>
+#include <queue>
+#include <assert.h>
+
+namespace {
+    // minimal user thread pool for the submit adapter
+    class UserPool {
+        std::mutex mutex{};
+        std::condition_variable cv{};
+        std::queue<std::function<void()>> jobs{};
+        std::vector<std::thread> threads{};
+        bool stop{};
+    public:
+        UserPool(size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                threads.emplace_back([this]() {
+                    while (true) {
+                        std::function<void()> job;
+                        {
+                            std::unique_lock lock{ mutex };
+                            cv.wait(lock, [this]() { return stop || !jobs.empty(); });
+                            if (jobs.empty()) {
+                                return;
+                            }
+                            job = std::move(jobs.front());
+                            jobs.pop();
+                        }
+                        job();
+                    }
+                });
+            }
+        }
+
+        ~UserPool() {
+            {
+                std::lock_guard lock{ mutex };
+                stop = true;
+            }
+            cv.notify_all();
+            for (std::thread& t : threads) {
+                t.join();
+            }
+        }
+
+        void Submit(std::function<void()> job) {
+            {
+                std::lock_guard lock{ mutex };
+                jobs.push(std::move(job));
+            }
+            cv.notify_one();
+        }
+    };
+
+    void TestExecutorSum(dbflib::DBExecutor& executor) {
+        std::vector<uint64_t> values(100000);
+        std::iota(values.begin(), values.end(), 0);
+        std::atomic<uint64_t> sum{};
+        dbflib::ParallelFor(executor, values.size(), 1000, [&](size_t begin, size_t end) {
+            uint64_t local = 0;
+            for (size_t i = begin; i < end; i++) {
+                local += values[i];
+            }
+            sum += local;
+        });
+        assert(sum == values.size() * (values.size() - 1) / 2 && "Bad parallel sum");
+
+        // nested runs
+        std::atomic<size_t> count{};
+        executor.Run(8, [&](size_t) {
+            executor.Run(8, [&](size_t) { count++; });
+        });
+        assert(count == 64 && "Bad nested run");
+
+        bool thrown = false;
+        try {
+            executor.Run(16, [](size_t i) {
+                if (i == 7) {
+                    throw std::runtime_error("task error");
+                }
+            });
+        } catch (std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown && "Task exception not rethrown");
+    }
+}
+
+void TestExecutor() {
+    dbflib::DBSerialExecutor serial{};
+    dbflib::DBWorkStealingExecutor pool{ 3 };
+    UserPool userPool{ 2 };
+    dbflib::DBSubmitExecutor submit{ [&userPool](std::function<void()> job) { userPool.Submit(std::move(job)); }, 2 };
+    TestExecutorSum(serial);
+    TestExecutorSum(pool);
+    TestExecutorSum(submit);
+    TestExecutorSum(dbflib::DefaultExecutor());
+
+    // parallel linking
+    struct Node {
+        Node* next;
+    };
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+    constexpr size_t count = 50000;
+    std::vector<dbflib::BlockId> ids{};
+    for (size_t i = 0; i < count; i++) {
+        ids.push_back(builder.CreateBlock<Node>().first);
+    }
+    for (size_t i = 0; i < count; i++) {
+        builder.CreateLink(ids[i], offsetof(Node, next), ids[(i + 1) % count]);
+    }
+    dbflib::DB_FILE* file = builder.Build();
+    assert(file->Link(pool, false, 1000) && "the file wasn't linked!");
+    assert(!file->Link(pool) && "the file was linked more than once!");
+    Node* node = file->Start<Node>();
+    for (size_t i = 0; i < count; i++) {
+        node = node->next;
+    }
+    assert(node == file->Start<Node>() && "Bad parallel linking");
+
+    std::cout << "ok for executor\n";
+}
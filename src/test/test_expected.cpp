@@ -0,0 +1,178 @@
+#include <dbflib.hpp>
+#include <tests.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <assert.h>
+
+#ifdef DBFLIB_EXPECTED
+namespace {
+    std::atomic<size_t> allocations{};
+}
+
+// count the allocations of the test binary, all the forms are replaced so they use the same allocator
+namespace {
+    void* CountedAlloc(size_t size, size_t alignment) noexcept {
+        allocations.fetch_add(1, std::memory_order_relaxed);
+        if (alignment <= alignof(std::max_align_t)) {
+            return std::malloc(size ? size : 1);
+        }
+        return std::aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+    }
+
+    void* CountedNew(size_t size, size_t alignment) {
+        if (void* ptr = CountedAlloc(size, alignment)) {
+            return ptr;
+        }
+        throw std::bad_alloc();
+    }
+}
+
+void* operator new(size_t size) {
+    return CountedNew(size, 0);
+}
+
+void* operator new[](size_t size) {
+    return CountedNew(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    return CountedNew(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return CountedNew(size, (size_t)alignment);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return CountedAlloc(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return CountedAlloc(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountedAlloc(size, (size_t)alignment);
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return CountedAlloc(size, (size_t)alignment);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept {
+    std::free(ptr);
+}
+
+namespace {
+    struct ExpectedRoot {
+        uint64_t value;
+        ExpectedRoot* self;
+    };
+}
+#endif
+
+void TestExpected() {
+#ifdef DBFLIB_EXPECTED
+    std::vector<uint8_t> data{};
+    std::filesystem::path tmp{ std::filesystem::temp_directory_path() / "dbflib_expected.dbf" };
+    {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        auto [rootId, root] = builder.CreateBlock<ExpectedRoot>();
+        root->value = 42;
+        builder.CreateLink(rootId, offsetof(ExpectedRoot, self), rootId);
+        dbflib::DB_FILE* file = builder.Build();
+        data.assign(reinterpret_cast<uint8_t*>(file), reinterpret_cast<uint8_t*>(file) + file->file_size);
+        builder.WriteToFile(tmp);
+    }
+    std::vector<uint8_t> bad{ data };
+    std::filesystem::path missingPath{ "/dbflib/missing/file" };
+
+    size_t before = allocations.load();
+    {
+        std::expected<dbflib::DBFileReader, dbflib::DbfError> reader = dbflib::DBFileReader::Open(data.data(), data.size());
+        assert(reader && "Can't open buffer");
+        ExpectedRoot* root = reader->GetStart<ExpectedRoot>();
+        assert(root->self == root && root->value == 42 && "Bad opened buffer");
+
+        std::expected<dbflib::DBFileReader, dbflib::DbfError> mapped = dbflib::DBFileReader::Open(tmp);
+        assert(mapped && "Can't open file");
+        assert(mapped->GetStart<ExpectedRoot>()->value == 42 && "Bad opened file");
+
+        // bad magic
+        bad[0] ^= 0xFF;
+        std::expected<dbflib::DBFileReader, dbflib::DbfError> badMagic = dbflib::DBFileReader::Open(bad.data(), bad.size());
+        assert(!badMagic && badMagic.error().code == dbflib::DBFEC_BAD_MAGIC && "Bad magic accepted");
+        bad[0] ^= 0xFF;
+
+        // truncated buffer
+        std::expected<void, dbflib::DbfError> truncated = reinterpret_cast<dbflib::DB_FILE*>(bad.data())->TryValidate(bad.size() - 1);
+        assert(!truncated && truncated.error().code == dbflib::DBFEC_READ_FILE_TOO_SMALL
+            && truncated.error().offset == offsetof(dbflib::DB_FILE, file_size) && "Truncated file accepted");
+
+        // link after the end of the file
+        dbflib::DB_FILE* file = reinterpret_cast<dbflib::DB_FILE*>(bad.data());
+        dbflib::DB_FILE_LINK* link = reinterpret_cast<dbflib::DB_FILE_LINK*>(bad.data() + file->links_table_offset);
+        link->destination = file->file_size + 1;
+        std::expected<bool, dbflib::DbfError> linked = file->TryLink();
+        assert(!linked && linked.error().code == dbflib::DBFEC_LINK_AFTER_END
+            && linked.error().offset == file->links_table_offset && "Invalid link accepted");
+        assert(!std::strcmp(linked.error().Message(), "invalid file: link after end file") && "Bad error message");
+
+        std::expected<dbflib::DBFileReader, dbflib::DbfError> missing = dbflib::DBFileReader::Open(missingPath);
+        assert(!missing && missing.error().code == dbflib::DBFEC_CANT_OPEN && "Missing file opened");
+    }
+    assert(allocations.load() == before && "Allocation in the load path");
+    std::filesystem::remove(tmp);
+
+    std::cout << "ok for expected\n";
+#else
+    std::cout << "skip expected, std::expected isn't available\n";
+#endif
+}
@@ -0,0 +1,52 @@
+#include <dbflib_front_coded.hpp>
+#include <tests.hpp>
+#include <algorithm>
+#include <set>
+#include <assert.h>
+
+void TestFrontCoded() {
+    std::set<std::string> stringSet{ "", "a", "aa", "aaa", "ab", "b" };
+    for (int i = 0; i < 3000; i++) {
+        stringSet.insert("https://example.com/path/" + std::to_string(i * 3));
+        stringSet.insert("https://example.com/a/very/long/common/prefix/of/more/than/32/bytes/" + std::to_string(i));
+    }
+    std::vector<std::string> strings{ stringSet.begin(), stringSet.end() };
+
+    for (uint32_t bucketSize : { 1, 4, 16, 100 }) {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::CreateFrontCoded(builder, strings, bucketSize);
+        dbflib::DB_FILE* file = builder.Build();
+        file->Link();
+        const dbflib::DB_FRONT_CODED* table = file->Start<dbflib::DB_FRONT_CODED>();
+
+        assert(table->count == strings.size() && "Bad front coded count");
+        size_t raw{};
+        for (uint32_t i = 0; i < strings.size(); i++) {
+            assert(table->Get(i) == strings[i] && "Bad front coded string");
+            assert(table->Find(strings[i]) == i && "Bad front coded find");
+            raw += strings[i].size();
+        }
+        if (bucketSize == 16) {
+            assert(table->data_size < raw / 2 && "Front coding didn't compress");
+        }
+
+        for (std::string_view missing : { "0", "aab", "ac", "c", "https://example.com/path/1", "https://example.com/path/30000", "https://example.com/path/" }) {
+            bool expected = std::binary_search(strings.begin(), strings.end(), missing);
+            assert(table->Contains(missing) == expected && "Bad front coded contains");
+        }
+
+        uint32_t next{};
+        table->ForEach([&](std::string_view str, uint32_t index) {
+            assert(index == next++ && str == strings[index] && "Bad front coded iteration");
+        });
+        assert(next == strings.size() && "Bad front coded iteration");
+    }
+
+    dbflib::DBFileBuilder emptyBuilder{};
+    dbflib::CreateFrontCoded(emptyBuilder, std::vector<std::string>{});
+    dbflib::DB_FILE* empty = emptyBuilder.Build();
+    empty->Link();
+    assert(!empty->Start<dbflib::DB_FRONT_CODED>()->Contains("") && "Empty table contains a string");
+
+    std::cout << "ok for front coded\n";
+}
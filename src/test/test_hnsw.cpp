@@ -0,0 +1,64 @@
+#include <dbflib_hnsw.hpp>
+#include <tests.hpp>
+#include <random>
+#include <set>
+#include <assert.h>
+
+void TestHnsw() {
+    constexpr uint32_t dimension = 20;
+    constexpr uint32_t count = 1500;
+    constexpr size_t k = 10;
+    std::mt19937 rnd{ 42 };
+    std::normal_distribution<float> normal{};
+
+    std::vector<float> vectors((size_t)count * dimension);
+    for (float& v : vectors) {
+        v = normal(rnd);
+    }
+    std::vector<float> queries((size_t)50 * dimension);
+    for (float& v : queries) {
+        v = normal(rnd);
+    }
+
+    for (dbflib::DB_HNSW_QUANTIZATION quantization : { dbflib::DBHQ_FLOAT32, dbflib::DBHQ_INT8 }) {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::DB_HNSW_OPTIONS options{};
+        options.m = 12;
+        options.ef_construction = 64;
+        options.quantization = quantization;
+        dbflib::CreateHnsw(builder, vectors, dimension, options);
+        std::filesystem::path tmp = "test_hnsw.bin";
+        builder.WriteToFile(tmp);
+        dbflib::DBFileReader reader{ tmp };
+        std::filesystem::remove(tmp);
+
+        const dbflib::DB_HNSW* index = reader.GetStart<dbflib::DB_HNSW>();
+        assert(index->count == count && index->dimension == dimension && "Bad hnsw header");
+
+        dbflib::DB_HNSW::SearchContext context{};
+        size_t found{};
+        for (size_t q = 0; q * dimension < queries.size(); q++) {
+            const float* query = queries.data() + q * dimension;
+            std::vector<std::pair<float, uint32_t>> exact{};
+            for (uint32_t id = 0; id < count; id++) {
+                exact.emplace_back(dbflib::hnsw::L2Squared(query, vectors.data() + (size_t)id * dimension, dimension), id);
+            }
+            std::partial_sort(exact.begin(), exact.begin() + k, exact.end());
+            std::set<uint32_t> expected{};
+            for (size_t i = 0; i < k; i++) {
+                expected.insert(exact[i].second);
+            }
+
+            std::vector<std::pair<float, uint32_t>> results = index->Search(query, k, 64, &context);
+            assert(results.size() == k && "Bad hnsw result count");
+            assert(std::is_sorted(results.begin(), results.end()) && "Hnsw results not sorted");
+            for (const auto& [distance, id] : results) {
+                found += expected.contains(id);
+            }
+        }
+        double recall = (double)found / (queries.size() / dimension * k);
+        assert(recall >= (quantization == dbflib::DBHQ_FLOAT32 ? 0.9 : 0.8) && "Bad hnsw recall");
+    }
+
+    std::cout << "ok for hnsw\n";
+}
@@ -0,0 +1,146 @@
+#include <dbflib_ingest.hpp>
+#include <tests.hpp>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    struct IngestRecord {
+        int64_t id;
+        double score;
+        uint64_t active;
+        dbflib::DB_INGEST_STRING name;
+    };
+
+    dbflib::DBIngestSchema IngestSchema() {
+        dbflib::DBIngestSchema schema{};
+        schema.Add("id", dbflib::DBIT_INT64)
+            .Add("score", dbflib::DBIT_DOUBLE)
+            .Add("active", dbflib::DBIT_BOOL)
+            .Add("name", dbflib::DBIT_STRING);
+        return schema;
+    }
+
+    dbflib::DB_INGEST_TABLE* BuildTable(dbflib::DBIngester& ingester, dbflib::DBFileBuilder& builder, const std::string& input, dbflib::DBExecutor& executor) {
+        ingester.Ingest(builder, input, executor);
+        dbflib::DB_FILE* file = builder.Build();
+        file->Validate();
+        file->Link();
+        return file->Start<dbflib::DB_INGEST_TABLE>();
+    }
+
+    std::string ExpectedName(size_t i) {
+        switch (i % 4) {
+        case 0: return "name " + std::to_string(i);
+        case 1: return "quote \"" + std::to_string(i) + "\", comma";
+        case 2: return "line\nbreak " + std::to_string(i);
+        default: return "";
+        }
+    }
+
+    void CheckTable(dbflib::DB_INGEST_TABLE* table, size_t count, const char* format) {
+        assert(table->count == count && "Bad ingested count");
+        assert(table->record_size == sizeof(IngestRecord) && "Bad ingested record size");
+        assert(table->column_count == 4 && "Bad ingested column count");
+        const dbflib::DB_INGEST_COLUMN* column = table->FindColumn("name");
+        assert(column && column->type == dbflib::DBIT_STRING && column->offset == offsetof(IngestRecord, name) && "Bad ingested column");
+        for (size_t i = 0; i < count; i++) {
+            IngestRecord* record = table->Record<IngestRecord>(i);
+            assert(record->id == (int64_t)i && "Bad ingested id");
+            assert(record->score == (double)i / 4 && "Bad ingested score");
+            assert(record->active == (i % 3 == 0) && "Bad ingested bool");
+            std::string_view name = table->String(record->name);
+            assert(name == ExpectedName(i) && "Bad ingested string");
+            assert(!name.data()[name.size()] && "Ingested string not null terminated");
+        }
+        std::cout << "ok for ingest " << format << "\n";
+    }
+}
+
+void TestIngest() {
+    constexpr size_t count = 2000;
+    dbflib::DBWorkStealingExecutor executor{ 2 };
+
+    std::string jsonl{};
+    std::string csv{ "name,ignored,id,score,active\r\n" };
+    for (size_t i = 0; i < count; i++) {
+        double score = (double)i / 4;
+        bool active = i % 3 == 0;
+        std::string name = ExpectedName(i);
+
+        std::string jsonName{};
+        for (char c : name) {
+            if (c == '"') {
+                jsonName += "\\\"";
+            } else if (c == '\n') {
+                jsonName += "\\n";
+            } else {
+                jsonName += c;
+            }
+        }
+        jsonl += "{\"id\": " + std::to_string(i) + ", \"nested\": {\"a\": [1, \"}\"]}, \"score\": " + std::to_string(score)
+            + ", \"active\": " + (active ? "true" : "false") + ", \"name\": " + (name.empty() ? "null" : "\"" + jsonName + "\"") + "}\n";
+        if (i % 100 == 0) {
+            jsonl += "\n";
+        }
+
+        std::string csvName{ "\"" };
+        for (char c : name) {
+            csvName += c;
+            if (c == '"') {
+                csvName += '"';
+            }
+        }
+        csvName += "\"";
+        csv += (name.empty() ? std::string{} : csvName) + ",x," + std::to_string(i) + "," + std::to_string(score) + "," + (active ? "1" : "0") + "\r\n";
+    }
+
+    // small chunks to split the records and the quoted fields
+    {
+        dbflib::DBIngester ingester{ IngestSchema(), dbflib::DBIF_JSON_LINES, 97 };
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        CheckTable(BuildTable(ingester, builder, jsonl, executor), count, "json lines");
+    }
+    {
+        dbflib::DBIngester ingester{ IngestSchema(), dbflib::DBIF_CSV, 61 };
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        CheckTable(BuildTable(ingester, builder, csv, executor), count, "csv");
+    }
+
+    // unicode escapes
+    {
+        dbflib::DBIngester ingester{ IngestSchema(), dbflib::DBIF_JSON_LINES };
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::DB_INGEST_TABLE* table = BuildTable(ingester, builder, "{\"name\": \"\\u00e9\\ud83d\\ude00\\t\"}", executor);
+        assert(table->count == 1 && "Bad unicode count");
+        assert(table->String(table->Record<IngestRecord>(0)->name) == "\xC3\xA9\xF0\x9F\x98\x80\t" && "Bad unicode escape");
+    }
+
+    // file ingestion
+    std::filesystem::path input{ std::filesystem::temp_directory_path() / "dbflib_ingest.csv" };
+    std::filesystem::path output{ std::filesystem::temp_directory_path() / "dbflib_ingest.dbf" };
+    {
+        std::ofstream os{ input, std::ios::binary };
+        os << csv;
+    }
+    {
+        dbflib::DBIngester ingester{ IngestSchema(), dbflib::DBIF_CSV, 4096 };
+        ingester.IngestFile(input, output, executor);
+        assert(ingester.RecordCount() == count && "Bad file record count");
+    }
+    {
+        dbflib::DBFileReader reader{ output };
+        CheckTable(reader.GetStart<dbflib::DB_INGEST_TABLE>(), count, "file");
+    }
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+
+#ifdef __cpp_exceptions
+    try {
+        dbflib::DBIngester ingester{ IngestSchema(), dbflib::DBIF_CSV };
+        dbflib::DBFileBuilder builder{};
+        ingester.Ingest(builder, "id,name\n1,\"unterminated\n", executor);
+        assert(false && "Unterminated field not detected");
+    } catch (std::runtime_error&) {
+    }
+#endif
+}
@@ -0,0 +1,79 @@
+#include <dbflib_packed_array.hpp>
+#include <tests.hpp>
+#include <random>
+#include <assert.h>
+
+namespace {
+    template<typename ValueType>
+    void TestPackedValues(const std::vector<ValueType>& values, dbflib::DB_PACKED_ENCODING encoding, size_t maxSize) {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::CreatePackedArray<ValueType>(builder, values, encoding);
+        dbflib::DB_FILE* file = builder.Build();
+        file->Link();
+        assert(file->file_size <= maxSize && "Packed array too big");
+
+        const dbflib::DB_PACKED_ARRAY<ValueType>* array = file->Start<dbflib::DB_PACKED_ARRAY<ValueType>>();
+        assert(array->Size() == values.size() && "Bad packed array size");
+        for (size_t i = 0; i < values.size(); i++) {
+            assert((*array)[i] == values[i] && "Bad packed array value");
+        }
+
+        std::vector<ValueType> decoded(values.size());
+        array->Decode(0, values.size(), decoded.data());
+        assert(decoded == values && "Bad packed array decoding");
+        if (values.size() > 300) {
+            array->Decode(70, 200, decoded.data());
+            assert(std::equal(decoded.begin(), decoded.begin() + 200, values.begin() + 70) && "Bad packed array range decoding");
+        }
+
+        size_t next{};
+        array->ForEach([&](ValueType v, size_t index) {
+            assert(index == next++ && v == values[index] && "Bad packed array iteration");
+        });
+        assert(next == values.size() && "Bad packed array iteration");
+    }
+}
+
+void TestPackedArray() {
+    std::mt19937_64 rnd{ 42 };
+
+    // small ids with a few outliers
+    std::vector<uint32_t> ids(10000);
+    for (uint32_t& v : ids) {
+        v = 1000 + rnd() % 500;
+    }
+    for (size_t i = 0; i < ids.size(); i += 97) {
+        ids[i] = (uint32_t)rnd();
+    }
+    TestPackedValues<uint32_t>(ids, dbflib::DBPE_FOR, ids.size() * sizeof(uint32_t) / 2);
+
+    // sorted timestamps
+    std::vector<uint64_t> timestamps(10000);
+    uint64_t t = 1700000000000ull;
+    for (uint64_t& v : timestamps) {
+        t += rnd() % 1000;
+        v = t;
+    }
+    TestPackedValues<uint64_t>(timestamps, dbflib::DBPE_DELTA, timestamps.size() * sizeof(uint64_t) / 5);
+    TestPackedValues<uint64_t>(timestamps, dbflib::DBPE_FOR, timestamps.size() * sizeof(uint64_t) / 2);
+
+    // every width
+    for (size_t width = 0; width <= 64; width++) {
+        std::vector<uint64_t> values(333);
+        for (uint64_t& v : values) {
+            v = width == 64 ? rnd() : rnd() & ((1ull << width) - 1);
+        }
+        TestPackedValues<uint64_t>(values, dbflib::DBPE_FOR, SIZE_MAX);
+        TestPackedValues<uint64_t>(values, dbflib::DBPE_DELTA, SIZE_MAX);
+        if (width <= 32) {
+            std::vector<uint32_t> values32(values.begin(), values.end());
+            TestPackedValues<uint32_t>(values32, dbflib::DBPE_FOR, SIZE_MAX);
+            TestPackedValues<uint32_t>(values32, dbflib::DBPE_DELTA, SIZE_MAX);
+        }
+    }
+
+    TestPackedValues<uint32_t>({}, dbflib::DBPE_FOR, SIZE_MAX);
+    TestPackedValues<uint32_t>({ 7 }, dbflib::DBPE_DELTA, SIZE_MAX);
+
+    std::cout << "ok for packed array\n";
+}
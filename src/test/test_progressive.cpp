@@ -0,0 +1,95 @@
+#include <dbflib_progressive.hpp>
+#include <tests.hpp>
+#include <assert.h>
+
+namespace {
+    struct ProgressiveNode {
+        uint64_t value;
+        ProgressiveNode* next;
+    };
+
+    struct ProgressiveRoot {
+        ProgressiveNode* lists[3];
+    };
+}
+
+void TestProgressiveLoader() {
+    constexpr size_t nodes = 1000;
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+    auto [rootId, root] = builder.CreateBlock<ProgressiveRoot>();
+
+    size_t sectionIds[3]{};
+    for (size_t l = 0; l < 3; l++) {
+        sectionIds[l] = builder.BeginSection((uint32_t)l);
+        dbflib::BlockId prev{};
+        for (size_t i = 0; i < nodes; i++) {
+            auto [id, node] = builder.CreateBlock<ProgressiveNode>();
+            node->value = l * nodes + i;
+            if (i) {
+                builder.CreateLink(id, offsetof(ProgressiveNode, next), prev);
+            }
+            prev = id;
+        }
+        builder.EndSection();
+        builder.CreateLink(rootId, (dbflib::BlockOffset)(offsetof(ProgressiveRoot, lists) + l * sizeof(ProgressiveNode*)), prev);
+    }
+
+    std::vector<uint8_t> copy{};
+    {
+        dbflib::DB_FILE* file = builder.Build();
+        copy.assign(reinterpret_cast<uint8_t*>(file), reinterpret_cast<uint8_t*>(file) + file->file_size);
+        assert(file->GetExtension(dbflib::DBFE_SECTIONS) && "Missing sections extension");
+    }
+
+    // file linked by the loader
+    {
+        std::vector<uint8_t> data{ copy };
+        dbflib::DBProgressiveLoader loader{ reinterpret_cast<dbflib::DB_FILE*>(data.data()), data.size(), 2 };
+        assert(loader.SectionCount() == 4 && "Bad section count");
+        ProgressiveRoot* r = loader.GetStart<ProgressiveRoot>();
+        assert(loader.IsReady(0) && "Start section not ready");
+        assert(loader.FindSection(r) == 0 && loader.FindSection(data.data() + data.size()) == 0 && "Bad pointer outside of the sections");
+        for (size_t l = 0; l < 3; l++) {
+            assert(loader.FindSection(r->lists[l]) == sectionIds[l] && "Bad pointer section");
+            size_t count = 0;
+            uint64_t expected = (l + 1) * nodes;
+            for (ProgressiveNode* node = loader.Access(r->lists[l]); node; node = node->next) {
+                assert(node->value == --expected && "Bad progressive node");
+                count++;
+            }
+            assert(count == nodes && "Bad progressive list");
+        }
+        loader.WaitAll();
+        loader.Ready(1).get();
+        assert(!loader.GetFile()->Link() && "File linked after the loader");
+    }
+
+    // sorted links are still read by the full link
+    {
+        std::vector<uint8_t> data{ copy };
+        dbflib::DBFileReader reader{ data.data(), data.size() };
+        ProgressiveRoot* r = reader.GetStart<ProgressiveRoot>();
+        for (size_t l = 0; l < 3; l++) {
+            size_t count = 0;
+            for (ProgressiveNode* node = r->lists[l]; node; node = node->next) {
+                count++;
+            }
+            assert(count == nodes && "Bad linked list");
+        }
+    }
+
+    // file without sections
+    {
+        dbflib::DBFileBuilder simple{};
+        auto [id, node] = simple.CreateBlock<ProgressiveNode>();
+        node->value = 42;
+        simple.CreateLink(id, offsetof(ProgressiveNode, next), id);
+        dbflib::DB_FILE* file = simple.Build();
+        dbflib::DBProgressiveLoader loader{ file, file->file_size };
+        assert(loader.SectionCount() == 1 && "Bad default section count");
+        ProgressiveNode* n = loader.GetStart<ProgressiveNode>();
+        assert(n->next == n && n->value == 42 && "Bad default section");
+    }
+
+    std::cout << "ok for progressive loader\n";
+}
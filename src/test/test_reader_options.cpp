@@ -0,0 +1,63 @@
+#include <dbflib.hpp>
+#include <tests.hpp>
+#include <cstring>
+#include <iterator>
+#include <assert.h>
+
+namespace {
+    struct ReaderOptionsRoot {
+        uint64_t size;
+        uint8_t* payload;
+        ReaderOptionsRoot* self;
+    };
+}
+
+void TestReaderOptions() {
+    std::vector<uint8_t> payload(1 << 20);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = (uint8_t)(i * 7 + (i >> 10));
+    }
+    std::filesystem::path tmp{ std::filesystem::temp_directory_path() / "dbflib_reader_options.dbf" };
+    {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        auto [rootId, root] = builder.CreateBlock<ReaderOptionsRoot>();
+        root->size = payload.size();
+        dbflib::BlockId payloadId = builder.CreateBlockView(payload.data(), payload.size());
+        builder.CreateLink(rootId, offsetof(ReaderOptionsRoot, payload), payloadId);
+        builder.CreateLink(rootId, offsetof(ReaderOptionsRoot, self), rootId);
+        builder.WriteToFile(tmp);
+    }
+
+    dbflib::DBWorkStealingExecutor pool{ 3 };
+    for (uint32_t options : {
+        0u,
+        (uint32_t)dbflib::DBFRO_PREFAULT,
+        (uint32_t)dbflib::DBFRO_MMAP,
+        (uint32_t)(dbflib::DBFRO_MMAP | dbflib::DBFRO_POPULATE),
+        (uint32_t)(dbflib::DBFRO_MMAP | dbflib::DBFRO_PREFAULT | dbflib::DBFRO_MLOCK),
+        }) {
+        dbflib::DBFileReader reader{ tmp, options, pool };
+        const ReaderOptionsRoot* root = reader.GetStart<ReaderOptionsRoot>();
+        assert(root->self == root && "Bad reader link");
+        assert(root->size == payload.size() && "Bad reader size");
+        assert(!std::memcmp(root->payload, payload.data(), payload.size()) && "Bad reader payload");
+
+        const dbflib::DB_FILE_READER_STATS& stats = reader.GetStats();
+        assert(stats.load.count() > 0 && stats.link.count() > 0 && "Reader stats not set");
+        assert((stats.prefault.count() > 0) == !!(options & dbflib::DBFRO_PREFAULT) && "Bad reader prefault stats");
+    }
+
+    // the private mapping isn't writing the links into the file
+    auto readFile = [&tmp]() {
+        std::ifstream in{ tmp, std::ios::binary };
+        return std::string{ std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{} };
+    };
+    std::string before = readFile();
+    {
+        dbflib::DBFileReader reader{ tmp, dbflib::DBFRO_MMAP };
+    }
+    assert(readFile() == before && "File modified by a mapping");
+    std::filesystem::remove(tmp);
+
+    std::cout << "ok for reader options\n";
+}
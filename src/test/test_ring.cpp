@@ -0,0 +1,137 @@
+#include <dbflib_ring.hpp>
+#include <tests.hpp>
+#include <iostream>
+#include <thread>
+#include <type_traits>
+#include <assert.h>
+
+#ifdef DBFLIB_POSIX
+#include <sys/wait.h>
+#endif
+
+namespace {
+    struct RingMessage {
+        uint64_t producer;
+        uint64_t index;
+        uint32_t count;
+        dbflib::DBRelPtr<uint64_t> values;
+        dbflib::DBRelPtr<const char> name;
+    };
+
+#ifdef DBFLIB_POSIX
+    void ProduceRing(dbflib::DBSharedRing& ring, uint64_t producer, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            dbflib::DB_RING_MESSAGE message = ring.Reserve();
+            dbflib::DBRingMessageBuilder builder{ message };
+            RingMessage* root = builder.Allocate<RingMessage>();
+            root->producer = producer;
+            root->index = i;
+            root->count = (uint32_t)(i % 8);
+            uint64_t* values = builder.Allocate<uint64_t>(root->count);
+            for (size_t j = 0; j < root->count; j++) {
+                values[j] = i + j;
+            }
+            root->values = values;
+            root->name = builder.AllocateString(i % 2 ? "odd" : "even");
+            ring.Commit(message, builder, 7);
+        }
+    }
+
+    void ConsumeRing(dbflib::DBSharedRing& ring, size_t producers, size_t count) {
+        std::vector<uint64_t> next(producers);
+        for (size_t i = 0; i < producers * count; i++) {
+            dbflib::DB_RING_MESSAGE message = ring.Peek();
+            assert(message.type == 7 && message.size >= sizeof(RingMessage) && "Bad ring message");
+            const RingMessage* root = message.Root<RingMessage>();
+            assert(root->producer < producers && root->index == next[root->producer]++ && "Bad ring order");
+            for (size_t j = 0; j < root->count; j++) {
+                assert(root->values[j] == root->index + j && "Bad ring message values");
+            }
+            assert(std::string_view{ root->name.Get() } == (root->index % 2 ? "odd" : "even") && "Bad ring message string");
+            ring.Release(message);
+        }
+        dbflib::DB_RING_MESSAGE message;
+        assert(!ring.TryPeek(message) && "Ring not empty");
+    }
+#endif
+}
+
+void TestRing() {
+    // the relative pointers stay valid when the memory containing them and their data is moved
+    static_assert(std::is_trivially_default_constructible_v<dbflib::DBRelPtr<uint64_t>> && !std::is_copy_constructible_v<dbflib::DBRelPtr<uint64_t>>);
+    alignas(uint64_t) uint8_t buffer[32]{};
+    auto* values = reinterpret_cast<uint64_t*>(buffer + 16);
+    auto* ptr = reinterpret_cast<dbflib::DBRelPtr<uint64_t>*>(buffer);
+    auto* ptr2 = reinterpret_cast<dbflib::DBRelPtr<uint64_t>*>(buffer + 8);
+    assert(!*ptr && !ptr->Get() && "Zeroed relative pointer not null");
+    *ptr = values + 1;
+    *ptr2 = ptr->Get();
+    values[1] = 42;
+    alignas(uint64_t) uint8_t copy[32];
+    std::memcpy(copy, buffer, sizeof(buffer));
+    std::memset(buffer, 0, sizeof(buffer));
+    auto* copyPtr = reinterpret_cast<dbflib::DBRelPtr<uint64_t>*>(copy);
+    auto* copyPtr2 = reinterpret_cast<dbflib::DBRelPtr<uint64_t>*>(copy + 8);
+    assert(copyPtr->Get() == reinterpret_cast<uint64_t*>(copy + 24) && **copyPtr == 42 && "Bad moved relative pointer");
+    assert(copyPtr2->Get() == copyPtr->Get() && "Bad relative pointer set from another");
+
+#ifdef DBFLIB_POSIX
+    {
+        // full ring
+        dbflib::DBSharedRing ring{ 4, 64 };
+        dbflib::DB_RING_MESSAGE message;
+        for (size_t i = 0; i < 4; i++) {
+            bool reserved = ring.TryReserve(message);
+            assert(reserved && "Can't reserve");
+            ring.Commit(message, 8);
+        }
+        bool full = !ring.TryReserve(message);
+        assert(full && "Full ring reserved");
+        bool peeked = ring.TryPeek(message);
+        assert(peeked && "Can't peek");
+        ring.Release(message);
+        bool reserved = ring.TryReserve(message);
+        assert(reserved && "Can't reserve released slot");
+    }
+
+    constexpr size_t count = 20000;
+    {
+        dbflib::DBSharedRing ring{ 64, 256 };
+        std::thread producer{ [&ring]() { ProduceRing(ring, 0, count); } };
+        ConsumeRing(ring, 1, count);
+        producer.join();
+    }
+
+    {
+        dbflib::DBSharedRing ring{ 64, 256, dbflib::DBRF_MULTI_PRODUCER };
+        std::vector<std::thread> producers{};
+        for (size_t i = 0; i < 3; i++) {
+            producers.emplace_back([&ring, i]() { ProduceRing(ring, i, count); });
+        }
+        ConsumeRing(ring, 3, count);
+        for (std::thread& t : producers) {
+            t.join();
+        }
+    }
+
+    {
+        // named ring, written by another process with its own mapping
+        std::string name{ "/dbflib_test_ring_" + std::to_string(getpid()) };
+        dbflib::DBSharedRing ring{ name, 16, 256 };
+        pid_t pid = fork();
+        assert(pid >= 0 && "Can't fork");
+        if (!pid) {
+            dbflib::DBSharedRing child{ name };
+            ProduceRing(child, 0, count);
+            _exit(0);
+        }
+        ConsumeRing(ring, 1, count);
+        int status{};
+        waitpid(pid, &status, 0);
+        dbflib::DBSharedRing::Unlink(name);
+        assert(WIFEXITED(status) && !WEXITSTATUS(status) && "Bad producer process");
+    }
+#endif
+
+    std::cout << "ok for ring\n";
+}
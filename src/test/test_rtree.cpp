@@ -0,0 +1,66 @@
+#include <dbflib_rtree.hpp>
+#include <tests.hpp>
+#include <random>
+#include <assert.h>
+
+void TestRTree() {
+    std::mt19937 rnd{ 42 };
+    std::uniform_real_distribution<float> position{ -180, 180 };
+    std::uniform_real_distribution<float> size{ 0, 2 };
+
+    std::vector<dbflib::DB_RTREE_BOX> items(10000);
+    for (dbflib::DB_RTREE_BOX& b : items) {
+        b.min_x = position(rnd);
+        b.min_y = position(rnd) / 2;
+        b.max_x = b.min_x + size(rnd);
+        b.max_y = b.min_y + size(rnd);
+    }
+
+    for (uint32_t nodeSize : { 2, 16 }) {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::CreateRTree(builder, items, nodeSize);
+        dbflib::DB_FILE* file = builder.Build();
+        file->Link();
+        const dbflib::DB_RTREE* tree = file->Start<dbflib::DB_RTREE>();
+        assert(tree->count == items.size() && "Bad r-tree count");
+
+        for (int q = 0; q < 50; q++) {
+            dbflib::DB_RTREE_BOX box{ position(rnd), position(rnd) / 2, 0, 0 };
+            box.max_x = box.min_x + size(rnd) * 10;
+            box.max_y = box.min_y + size(rnd) * 10;
+
+            std::vector<uint32_t> expected{};
+            for (uint32_t i = 0; i < items.size(); i++) {
+                const dbflib::DB_RTREE_BOX& b = items[i];
+                if (b.min_x <= box.max_x && b.min_y <= box.max_y && b.max_x >= box.min_x && b.max_y >= box.min_y) {
+                    expected.push_back(i);
+                }
+            }
+            std::vector<uint32_t> found = tree->Search(box);
+            std::sort(found.begin(), found.end());
+            assert(found == expected && "Bad r-tree search");
+
+            float x = position(rnd);
+            float y = position(rnd) / 2;
+            std::vector<std::pair<float, uint32_t>> exact{};
+            for (uint32_t i = 0; i < items.size(); i++) {
+                exact.emplace_back(items[i].Distance(x, y), i);
+            }
+            std::sort(exact.begin(), exact.end());
+            std::vector<std::pair<float, uint32_t>> neighbors = tree->Neighbors(x, y, 5);
+            assert(neighbors.size() == 5 && "Bad r-tree neighbor count");
+            for (size_t i = 0; i < neighbors.size(); i++) {
+                assert(neighbors[i].first == exact[i].first && "Bad r-tree neighbors");
+            }
+        }
+        assert(tree->Neighbors(0, 0, 5, 0.0001f).size() <= 5 && "Bad r-tree neighbors");
+    }
+
+    dbflib::DBFileBuilder emptyBuilder{};
+    dbflib::CreateRTree(emptyBuilder, {});
+    dbflib::DB_FILE* empty = emptyBuilder.Build();
+    empty->Link();
+    assert(empty->Start<dbflib::DB_RTREE>()->Search(dbflib::DB_RTREE_BOX{ -1, -1, 1, 1 }).empty() && "Empty r-tree search");
+
+    std::cout << "ok for r-tree\n";
+}
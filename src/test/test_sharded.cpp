@@ -0,0 +1,70 @@
+#include <dbflib_sharded.hpp>
+#include <tests.hpp>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    struct ShardedRecord {
+        uint64_t value;
+        ShardedRecord* next;
+        const char* name;
+    };
+}
+
+void TestShardedFile() {
+    constexpr size_t roots = 1000;
+    constexpr size_t chain = 4;
+    std::filesystem::path dir{ std::filesystem::temp_directory_path() / "dbflib_sharded" };
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir / "a");
+    std::filesystem::create_directories(dir / "b");
+
+    std::filesystem::path manifestPath;
+    {
+        dbflib::DBShardedFileBuilder builder{ dir, "dataset", 0x2000, dbflib::DBFBO_ALIGN, { dir / "a", dir / "b" } };
+        for (size_t i = 0; i < roots; i++) {
+            dbflib::DBFileBuilder& shard = builder.Builder(chain * sizeof(ShardedRecord) + 16, chain * 2);
+            dbflib::BlockId prev{};
+            for (size_t j = 0; j < chain; j++) {
+                std::string name = "r" + std::to_string(i * chain + j);
+                auto [id, record] = shard.CreateBlock<ShardedRecord>();
+                record->value = i * chain + (chain - j - 1);
+                dbflib::BlockId nameId = shard.CreateBlock(name.c_str(), name.size() + 1);
+                shard.CreateLink(id, offsetof(ShardedRecord, name), nameId);
+                if (j) {
+                    shard.CreateLink(id, offsetof(ShardedRecord, next), prev);
+                }
+                prev = id;
+            }
+            assert(builder.AddRoot(prev) == i && "Bad sharded root index");
+        }
+        manifestPath = builder.Finish();
+    }
+    assert(std::filesystem::exists(dir / "dataset.manifest.dbf") && "Missing manifest");
+    assert(std::filesystem::exists(dir / "a" / "dataset.0.dbf") && "Missing shard 0");
+    assert(std::filesystem::exists(dir / "b" / "dataset.1.dbf") && "Missing shard 1");
+
+    dbflib::DBWorkStealingExecutor executor{ 2 };
+    dbflib::DBShardedFileReader reader{ manifestPath, dbflib::DBFRO_MMAP, executor };
+    assert(reader.ShardCount() > 2 && "Bad shard count");
+    assert(reader.RootCount() == roots && "Bad sharded root count");
+    for (size_t i = 0; i < reader.ShardCount(); i++) {
+        assert(reader.GetShard(i).GetFile()->file_size <= 0x2000 && "Shard too big");
+    }
+
+    size_t i = 0;
+    reader.ForEachRoot<ShardedRecord>([&i](ShardedRecord* record) {
+        for (size_t j = 0; j < chain; j++) {
+            size_t value = i * chain + j;
+            assert(record && record->value == value && "Bad sharded record");
+            assert(std::string{ record->name } == "r" + std::to_string(i * chain + (chain - j - 1)) && "Bad sharded name");
+            record = record->next;
+        }
+        assert(!record && "Bad sharded chain end");
+        i++;
+    });
+    assert(i == roots && "Bad sharded root iteration");
+
+    std::filesystem::remove_all(dir);
+    std::cout << "ok for sharded file\n";
+}
@@ -0,0 +1,109 @@
+#include <dbflib.hpp>
+#include <tests.hpp>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    struct SparseRoot {
+        uint64_t slots;
+        uint64_t* table;
+        uint64_t* tail;
+    };
+
+    // mostly empty hash table between 2 small blocks
+    void CreateSparse(dbflib::DBFileBuilder& builder) {
+        constexpr size_t slots = 1 << 18;
+        auto [rootId, root] = builder.CreateBlock<SparseRoot>();
+        root->slots = slots;
+        auto [tableId, table] = builder.CreateBlock<uint64_t>(slots * sizeof(uint64_t));
+        for (size_t i = 0; i < slots; i += 40000) {
+            table[i] = i + 1;
+        }
+        auto [tailId, tail] = builder.CreateBlock<uint64_t>();
+        *tail = 42;
+        builder.CreateLink(rootId, offsetof(SparseRoot, table), tableId);
+        builder.CreateLink(rootId, offsetof(SparseRoot, tail), tailId);
+    }
+
+    std::string ReadAll(const std::filesystem::path& path) {
+        std::ifstream in{ path, std::ios::binary };
+        return std::string{ std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+    }
+
+    void CheckSparse(SparseRoot* root) {
+        assert(root->slots == 1 << 18 && *root->tail == 42 && "Bad sparse root");
+        for (size_t i = 0; i < root->slots; i++) {
+            assert(root->table[i] == (i % 40000 ? 0 : i + 1) && "Bad sparse table");
+        }
+    }
+}
+
+void TestSparse() {
+    std::filesystem::path dense{ std::filesystem::temp_directory_path() / "dbflib_dense.dbf" };
+    std::filesystem::path sparse{ std::filesystem::temp_directory_path() / "dbflib_sparse.dbf" };
+    {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        CreateSparse(builder);
+        builder.WriteToFile(dense);
+    }
+    {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        CreateSparse(builder);
+        builder.WriteToFile(sparse, dbflib::DBFWO_SPARSE);
+    }
+    std::string denseData = ReadAll(dense);
+    assert(ReadAll(sparse) == denseData && "Bad sparse content");
+
+#ifdef DBFLIB_POSIX
+    {
+        int fd = open(sparse.c_str(), O_RDONLY);
+        assert(fd >= 0 && "Can't open sparse file");
+        struct stat st;
+        int err = fstat(fd, &st);
+        assert(!err && "Can't stat sparse file");
+#ifdef SEEK_HOLE
+        // only if the file system supports the holes
+        off_t hole = lseek(fd, 0, SEEK_HOLE);
+        if (hole >= 0 && hole < st.st_size) {
+            assert((size_t)st.st_blocks * 512 < (size_t)st.st_size / 4 && "Sparse file not sparse");
+        } else {
+            std::cout << "holes not supported, only checking the sparse content\n";
+        }
+#endif
+        close(fd);
+    }
+
+    // overwrite an existing file
+    {
+        std::ofstream os{ sparse, std::ios::binary };
+        std::string garbage(denseData.size() + 0x3000, '\xAB');
+        os << garbage;
+    }
+    {
+        int fd = open(sparse.c_str(), O_WRONLY);
+        assert(fd >= 0 && "Can't open sparse file");
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        CreateSparse(builder);
+        builder.WriteTo(fd, dbflib::DBFWO_SPARSE);
+        off_t pos = lseek(fd, 0, SEEK_CUR);
+        assert((size_t)pos == denseData.size() && "Bad sparse file position");
+        int err = ftruncate(fd, pos);
+        assert(!err && "Can't truncate sparse file");
+        close(fd);
+    }
+    assert(ReadAll(sparse) == denseData && "Bad overwritten sparse content");
+#endif
+
+    {
+        dbflib::DBFileReader reader{ sparse };
+        CheckSparse(reader.GetStart<SparseRoot>());
+    }
+    {
+        dbflib::DBFileReader reader{ sparse, dbflib::DBFRO_MMAP };
+        CheckSparse(reader.GetStart<SparseRoot>());
+    }
+
+    std::filesystem::remove(dense);
+    std::filesystem::remove(sparse);
+    std::cout << "ok for sparse\n";
+}
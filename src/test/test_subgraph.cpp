@@ -0,0 +1,109 @@
+#include <dbflib_subgraph.hpp>
+#include <tests.hpp>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    struct SubgraphNode {
+        uint64_t value;
+        SubgraphNode* left;
+        SubgraphNode* right;
+        // pointer inside the values of another node
+        uint64_t* item;
+        uint64_t values[4];
+    };
+
+    struct SubgraphRoot {
+        uint64_t count;
+        SubgraphNode* tenants[8];
+    };
+
+    // tree of depth nodes, the leaves are pointing to the tree root
+    dbflib::BlockId CreateTree(dbflib::DBFileBuilder& builder, uint64_t tenant, size_t depth, dbflib::BlockId root = 0) {
+        auto [id, node] = builder.CreateBlock<SubgraphNode>();
+        node->value = tenant * 1000 + depth;
+        for (size_t i = 0; i < 4; i++) {
+            node->values[i] = tenant * 100 + i;
+        }
+        if (!root) {
+            root = id;
+        }
+        if (depth) {
+            dbflib::BlockId left = CreateTree(builder, tenant, depth - 1, root);
+            dbflib::BlockId right = CreateTree(builder, tenant, depth - 1, root);
+            builder.CreateLink(id, offsetof(SubgraphNode, left), left);
+            builder.CreateLink(id, offsetof(SubgraphNode, right), right);
+        } else {
+            builder.CreateLink(id, offsetof(SubgraphNode, left), root);
+        }
+        builder.CreateLink(id, offsetof(SubgraphNode, item), root, (dbflib::BlockOffset)(offsetof(SubgraphNode, values) + 2 * sizeof(uint64_t)));
+        return id;
+    }
+
+    size_t CheckTree(SubgraphNode* node, uint64_t tenant, size_t depth, SubgraphNode* root) {
+        assert(node->value == tenant * 1000 + depth && "Bad subgraph node");
+        assert(node->item == &root->values[2] && *node->item == tenant * 100 + 2 && "Bad subgraph inner link");
+        if (!depth) {
+            assert(node->left == root && !node->right && "Bad subgraph leaf");
+            return 1;
+        }
+        return 1 + CheckTree(node->left, tenant, depth - 1, root) + CheckTree(node->right, tenant, depth - 1, root);
+    }
+}
+
+void TestSubgraph() {
+    constexpr size_t tenants = 8;
+    constexpr size_t depth = 6;
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN | dbflib::DBFBO_BLOCK_TABLE };
+    auto [rootId, root] = builder.CreateBlock<SubgraphRoot>();
+    root->count = tenants;
+    for (size_t t = 0; t < tenants; t++) {
+        dbflib::BlockId tree = CreateTree(builder, t, depth);
+        builder.CreateLink(rootId, (dbflib::BlockOffset)(offsetof(SubgraphRoot, tenants) + t * sizeof(SubgraphNode*)), tree);
+    }
+    dbflib::DB_FILE* file = builder.Build();
+    file->Validate();
+    file->Link();
+
+    size_t blocksSize{};
+    const dbflib::DB_FILE_BLOCK* blocks = file->GetExtension<const dbflib::DB_FILE_BLOCK>(dbflib::DBFE_BLOCKS, &blocksSize);
+    size_t treeNodes = (1 << (depth + 1)) - 1;
+    assert(blocks && blocksSize / sizeof(dbflib::DB_FILE_BLOCK) == 1 + tenants * treeNodes && "Bad block table");
+    for (size_t i = 1; i < blocksSize / sizeof(dbflib::DB_FILE_BLOCK); i++) {
+        assert(blocks[i - 1].offset < blocks[i].offset && "Block table not sorted");
+    }
+
+    dbflib::DBSubgraphExtractor extractor{ file };
+    SubgraphRoot* fileRoot = file->Start<SubgraphRoot>();
+    std::filesystem::path tmp{ std::filesystem::temp_directory_path() / "dbflib_subgraph.dbf" };
+    for (size_t t : { 3, 6 }) {
+        extractor.ExtractToFile(fileRoot->tenants[t], tmp);
+        dbflib::DBFileReader reader{ tmp };
+        dbflib::DB_FILE* sub = reader.GetFile();
+        assert(sub->links_count == (treeNodes - 1) / 2 * 3 + (treeNodes + 1) / 2 * 2 && "Bad subgraph links count");
+        assert(sub->file_size < file->file_size / 4 && "Subgraph not compact");
+        SubgraphNode* tree = reader.GetStart<SubgraphNode>();
+        assert(CheckTree(tree, t, depth, tree) == treeNodes && "Bad subgraph node count");
+    }
+
+    // root inside a block
+    extractor.ExtractToFile(fileRoot->tenants[5]->item, tmp);
+    {
+        dbflib::DBFileReader reader{ tmp };
+        uint64_t* item = reader.GetStart<uint64_t>();
+        assert(*item == 502 && "Bad subgraph inner root");
+    }
+
+    std::filesystem::remove(tmp);
+
+#ifdef __cpp_exceptions
+    try {
+        dbflib::DBFileBuilder noTable{};
+        noTable.CreateBlock<SubgraphRoot>();
+        dbflib::DBSubgraphExtractor invalid{ noTable.Build() };
+        assert(false && "File without block table not detected");
+    } catch (std::runtime_error&) {
+    }
+#endif
+    std::cout << "ok for subgraph\n";
+}
@@ -0,0 +1,155 @@
+#include <dbflib_subgraph.hpp>
+#include <tests.hpp>
+#include <iostream>
+#include <assert.h>
+
+namespace {
+    struct SymbolShape {
+        virtual ~SymbolShape() = default;
+        virtual uint64_t Area() const = 0;
+    };
+
+    struct SymbolSquare : SymbolShape {
+        uint64_t side{};
+        uint64_t Area() const override { return side * side; }
+    };
+
+    struct SymbolRectangle : SymbolShape {
+        uint64_t width{};
+        uint64_t height{};
+        uint64_t Area() const override { return width * height; }
+    };
+
+    struct SymbolRoot {
+        uint64_t (*transform)(uint64_t);
+        size_t count;
+        SymbolShape* shapes[6];
+    };
+
+    uint64_t SymbolDouble(uint64_t v) {
+        return v * 2;
+    }
+
+    uint64_t SymbolTriple(uint64_t v) {
+        return v * 3;
+    }
+
+    // copy a host object in a block without its vtable pointer
+    template<typename Type>
+    dbflib::BlockId CreateObject(dbflib::DBFileBuilder& builder, const Type& object, const char* symbol) {
+        auto [id, ptr] = builder.CreateBlock<Type>();
+        std::memcpy(static_cast<void*>(ptr), &object, sizeof(Type));
+        std::memset(static_cast<void*>(ptr), 0, sizeof(void*));
+        builder.CreateSymbolLink(id, 0, symbol);
+        return id;
+    }
+}
+
+void TestSymbols() {
+    static_assert(dbflib::SymbolHash("SymbolSquare") != dbflib::SymbolHash("SymbolRectangle") && "Bad symbol hash");
+
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN | dbflib::DBFBO_BLOCK_TABLE };
+    auto [rootId, root] = builder.CreateBlock<SymbolRoot>();
+    root->count = 6;
+    builder.CreateSymbolLink(rootId, offsetof(SymbolRoot, transform), "transform");
+
+    uint64_t expected{};
+    for (size_t i = 0; i < 6; i++) {
+        dbflib::BlockId id;
+        if (i % 2) {
+            SymbolRectangle rect{};
+            rect.width = i;
+            rect.height = i + 1;
+            expected += rect.Area();
+            id = CreateObject(builder, rect, "SymbolRectangle");
+        } else {
+            SymbolSquare square{};
+            square.side = i + 2;
+            expected += square.Area();
+            id = CreateObject(builder, square, "SymbolSquare");
+        }
+        builder.CreateLink(rootId, (dbflib::BlockOffset)(offsetof(SymbolRoot, shapes) + i * sizeof(void*)), id);
+    }
+
+    std::filesystem::path path{ "test_symbols.dbf" };
+    builder.WriteToFile(path);
+
+    dbflib::DBSymbolRegistry registry{};
+    registry.Register("transform", &SymbolDouble);
+    registry.RegisterVTable<SymbolSquare>("SymbolSquare");
+    registry.RegisterVTable<SymbolRectangle>("SymbolRectangle");
+    registry.RegisterVTable<SymbolSquare>("SymbolSquare");
+    assert(registry.Size() == 3 && "Bad registry size");
+#ifdef __cpp_exceptions
+    bool thrown = false;
+    try {
+        registry.Register("transform", &SymbolTriple);
+    } catch (std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown && "Symbol registered twice");
+#endif
+
+    auto check = [expected](SymbolRoot* r, uint64_t factor) {
+        uint64_t area{};
+        for (size_t i = 0; i < r->count; i++) {
+            area += r->shapes[i]->Area();
+        }
+        assert(area == expected && "Bad virtual call");
+        assert(r->transform(area) == expected * factor && "Bad function symbol");
+    };
+
+    {
+        dbflib::DBFileReader reader{ path, registry };
+        check(reader.GetStart<SymbolRoot>(), 2);
+
+        // rebind with other symbols
+        dbflib::DBSymbolRegistry other{};
+        other.Register("transform", &SymbolTriple);
+        other.RegisterVTable<SymbolSquare>("SymbolSquare");
+        other.RegisterVTable<SymbolRectangle>("SymbolRectangle");
+        reader.GetFile()->BindSymbols(other);
+        check(reader.GetStart<SymbolRoot>(), 3);
+    }
+
+    {
+        dbflib::DBFileReader reader{ path, registry, dbflib::DBFRO_MMAP };
+        check(reader.GetStart<SymbolRoot>(), 2);
+    }
+
+    {
+        // the extracted symbol links are stored as symbols, not as the bound addresses
+        std::filesystem::path extracted{ "test_symbols_extracted.dbf" };
+        {
+            dbflib::DBFileReader reader{ path, registry };
+            dbflib::DBSubgraphExtractor extractor{ reader.GetFile() };
+            extractor.ExtractToFile(reader.GetStart(), extracted);
+        }
+        {
+            dbflib::DBFileReader reader{ extracted };
+            SymbolRoot* r = reader.GetStart<SymbolRoot>();
+            assert(!r->transform && "Symbol address extracted");
+            void* vtable;
+            std::memcpy(&vtable, r->shapes[0], sizeof(vtable));
+            assert(!vtable && "Vtable address extracted");
+        }
+        {
+            dbflib::DBFileReader reader{ extracted, registry };
+            check(reader.GetStart<SymbolRoot>(), 2);
+        }
+        std::filesystem::remove(extracted);
+    }
+
+    {
+        // unresolved symbol
+        dbflib::DBSymbolRegistry partial{};
+        partial.Register("transform", &SymbolDouble);
+        dbflib::DBFileReader reader{ path };
+        dbflib::DbfError error{};
+        assert(!reader.GetFile()->BindSymbols(partial, error) && error.code == dbflib::DBFEC_UNRESOLVED_SYMBOL && "Symbol resolved");
+    }
+
+    std::filesystem::remove(path);
+
+    std::cout << "ok for symbols\n";
+}
@@ -0,0 +1,55 @@
+#include <dbflib_time_series.hpp>
+#include <tests.hpp>
+#include <cmath>
+#include <random>
+#include <assert.h>
+
+void TestTimeSeries() {
+    std::mt19937 rnd{ 42 };
+    std::vector<dbflib::DB_TIME_SERIES_POINT> points(100000);
+    int64_t t = 1700000000000;
+    double v = 20;
+    for (size_t i = 0; i < points.size(); i++) {
+        // regular interval with some jitter and gaps
+        t += 10000 + (rnd() % 10 == 0 ? (int64_t)(rnd() % 200) - 100 : 0) + (i % 5000 == 0 ? 3600000 : 0);
+        if (rnd() % 4 == 0) {
+            v = std::round((v + (double)((int)(rnd() % 21) - 10) / 100) * 100) / 100;
+        }
+        points[i] = { t, v };
+    }
+    points[500].value = NAN;
+    points[501].value = -1e300;
+    points[502].timestamp = points[501].timestamp;
+
+    for (uint32_t pointsPerChunk : { 1, 1000 }) {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        dbflib::CreateTimeSeries(builder, points, pointsPerChunk);
+        dbflib::DB_FILE* file = builder.Build();
+        file->Link();
+        const dbflib::DB_TIME_SERIES* series = file->Start<dbflib::DB_TIME_SERIES>();
+        assert(series->point_count == points.size() && "Bad time series size");
+        if (pointsPerChunk > 1) {
+            assert(file->file_size < points.size() * sizeof(points[0]) / 5 && "Time series not compressed");
+        }
+
+        dbflib::DBTimeSeriesDecoder decoder{ *series };
+        dbflib::DB_TIME_SERIES_POINT p;
+        size_t i{};
+        while (decoder.Next(p)) {
+            assert(p.timestamp == points[i].timestamp && "Bad time series timestamp");
+            assert(std::bit_cast<uint64_t>(p.value) == std::bit_cast<uint64_t>(points[i].value) && "Bad time series value");
+            i++;
+        }
+        assert(i == points.size() && "Bad time series point count");
+
+        int64_t from = points[12345].timestamp;
+        int64_t to = points[23456].timestamp;
+        size_t first = 12345;
+        series->Scan(from, to, [&](const dbflib::DB_TIME_SERIES_POINT& point) {
+            assert(point.timestamp == points[first++].timestamp && "Bad time series scan");
+        });
+        assert(first == 23457 && "Bad time series scan range");
+    }
+
+    std::cout << "ok for time series\n";
+}
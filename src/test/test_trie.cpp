@@ -0,0 +1,68 @@
+#include <dbflib_trie.hpp>
+#include <tests.hpp>
+#include <algorithm>
+#include <set>
+#include <assert.h>
+
+void TestTrie() {
+    std::set<std::string> keySet{ "", "a", "ab", "abc", "abd", "b", "ba", "zzz" };
+    for (int i = 0; i < 5000; i++) {
+        keySet.insert("key" + std::to_string(i * 7));
+        keySet.insert(std::to_string(i * 13) + "/value");
+    }
+    std::vector<std::string> keys{ keySet.begin(), keySet.end() };
+
+    dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+    dbflib::CreateTrie(builder, keys);
+    std::filesystem::path tmp = "test_trie.bin";
+    builder.WriteToFile(tmp);
+    dbflib::DBFileReader reader{ tmp };
+    std::filesystem::remove(tmp);
+
+    const dbflib::DB_TRIE* trie = reader.GetStart<dbflib::DB_TRIE>();
+    assert(trie->key_count == keys.size() && "Bad trie key count");
+
+    std::vector<bool> seen(keys.size());
+    for (const std::string& key : keys) {
+        uint32_t id = trie->Lookup(key);
+        assert(id != dbflib::DB_TRIE::npos && "Missing trie key");
+        assert(!seen[id] && "Duplicated trie id");
+        seen[id] = true;
+        assert(trie->Key(id) == key && "Bad trie id mapping");
+    }
+    assert(!trie->Contains("key1") && "Unknown trie key found");
+    assert(!trie->Contains("abcd") && "Unknown trie key found");
+    assert(!trie->Contains("zz") && "Unknown trie key found");
+
+    auto CheckPrefix = [&](std::string_view prefix) {
+        std::vector<std::string> expected{};
+        for (const std::string& key : keys) {
+            if (key.starts_with(prefix)) {
+                expected.push_back(key);
+            }
+        }
+        std::vector<std::string> found{};
+        trie->ForEachPrefix(prefix, [&](std::string_view key, uint32_t id) {
+            assert(trie->Key(id) == key && "Bad trie prefix id");
+            found.emplace_back(key);
+        });
+        assert(found == expected && "Bad trie prefix iteration");
+    };
+    CheckPrefix("");
+    CheckPrefix("ab");
+    CheckPrefix("key12");
+    CheckPrefix("1");
+    CheckPrefix("nope");
+
+    size_t count{};
+    trie->ForEachPrefix("key", [&count](std::string_view, uint32_t) { return ++count < 3; });
+    assert(count == 3 && "Trie prefix iteration didn't stop");
+
+    dbflib::DBFileBuilder emptyBuilder{};
+    dbflib::CreateTrie(emptyBuilder, std::vector<std::string>{});
+    dbflib::DB_FILE* empty = emptyBuilder.Build();
+    empty->Link();
+    assert(!empty->Start<dbflib::DB_TRIE>()->Contains("") && "Empty trie contains a key");
+
+    std::cout << "ok for trie\n";
+}
@@ -0,0 +1,111 @@
+#include <dbflib.hpp>
+#include <tests.hpp>
+#include <cstring>
+#include <sstream>
+#include <thread>
+#include <assert.h>
+#ifdef DBFLIB_POSIX
+#include <sys/socket.h>
+#endif
+
+namespace {
+    struct WriteToRoot {
+        uint64_t size;
+        uint8_t* payload;
+    };
+
+    void ValidateWriteTo(std::string& data, const std::vector<uint8_t>& payload) {
+        dbflib::DBFileReader reader{ data.data(), data.size() };
+        const WriteToRoot* root = reader.GetStart<WriteToRoot>();
+        assert(root->size == payload.size() && "Bad written size");
+        assert(!std::memcmp(root->payload, payload.data(), payload.size()) && "Bad written payload");
+    }
+
+#ifdef DBFLIB_POSIX
+    // write with func into fds[1] and read fds[0] from another thread
+    template<typename Func>
+    std::string ReadFrom(int fds[2], Func&& func) {
+        std::string data{};
+        std::thread reader{ [&data, fds]() {
+            char buffer[0x1000];
+            ssize_t r;
+            while ((r = read(fds[0], buffer, sizeof(buffer))) > 0) {
+                data.append(buffer, (size_t)r);
+            }
+        } };
+        func(fds[1]);
+        close(fds[1]);
+        reader.join();
+        close(fds[0]);
+        return data;
+    }
+#endif
+}
+
+void TestWriteTo() {
+    // bigger than the pipe buffers
+    std::vector<uint8_t> payload(1 << 20);
+    for (size_t i = 0; i < payload.size(); i++) {
+        payload[i] = (uint8_t)(i * 13 + (i >> 12));
+    }
+    std::filesystem::path tmp{ std::filesystem::temp_directory_path() / "dbflib_write_to.dbf" };
+
+    auto build = [&payload](dbflib::DBFileBuilder& builder) {
+        auto [rootId, root] = builder.CreateBlock<WriteToRoot>();
+        root->size = payload.size();
+        dbflib::BlockId payloadId = builder.CreateBlockView(payload.data(), payload.size());
+        builder.CreateLink(rootId, offsetof(WriteToRoot, payload), payloadId);
+    };
+
+    {
+        dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+        build(builder);
+        std::ostringstream out{};
+        builder.WriteTo(out);
+        std::string data = out.str();
+        ValidateWriteTo(data, payload);
+    }
+
+#ifdef DBFLIB_POSIX
+    for (uint32_t options : { 0u, (uint32_t)dbflib::DBFWO_ZERO_COPY }) {
+        int fds[2];
+        {
+            dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+            build(builder);
+            int err = pipe(fds);
+            assert(!err && "Can't create pipe");
+            std::string data = ReadFrom(fds, [&](int fd) { builder.WriteTo(fd, options); });
+            ValidateWriteTo(data, payload);
+        }
+        {
+            dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+            build(builder);
+            int err = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+            assert(!err && "Can't create socket pair");
+            std::string data = ReadFrom(fds, [&](int fd) { builder.WriteTo(fd, options); });
+            ValidateWriteTo(data, payload);
+        }
+        {
+            dbflib::DBFileBuilder builder{ dbflib::DBFBO_ALIGN };
+            build(builder);
+            int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            assert(fd >= 0 && "Can't open file");
+            builder.WriteTo(fd, options);
+            close(fd);
+            dbflib::DBFileReader reader{ tmp };
+            assert(!std::memcmp(reader.GetStart<WriteToRoot>()->payload, payload.data(), payload.size()) && "Bad written file");
+        }
+    }
+
+    {
+        int fds[2];
+        int err = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        assert(!err && "Can't create socket pair");
+        std::string data = ReadFrom(fds, [&tmp](int fd) { dbflib::SendFile(tmp, fd); });
+        ValidateWriteTo(data, payload);
+    }
+    std::filesystem::remove(tmp);
+#endif
+
+    std::cout << "ok for write to\n";
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+/*
+ * Library tests, each test asserts its results and prints "ok for <name>"
+ */
+void TestTrie();
+void TestFrontCoded();
+void TestPackedArray();
+void TestBloomFilter();
+void TestCsrGraph();
+void TestHnsw();
+void TestRTree();
+void TestTimeSeries();
+void TestDictionaryColumn();
+void TestBlockView();
+void TestWriteTo();
+void TestConcurrentBuilder();
+void TestExecutor();
+void TestReaderOptions();
+void TestProgressiveLoader();
+void TestExpected();
+void TestShardedFile();
+void TestIngest();
+void TestArrow();
+void TestSubgraph();
+void TestBlockTypes();
+void TestSparse();
+void TestSymbols();
+void TestRing();
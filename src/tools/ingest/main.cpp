@@ -0,0 +1,94 @@
+#include <dbflib_ingest.hpp>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+    void Usage() {
+        std::fprintf(stderr,
+            "usage: dbfingest [options] <jsonl|csv> <input> <output> <column:type>...\n"
+            "types: int64, double, bool, string\n"
+            "options:\n"
+            "    --threads <n>  parser thread count, the default pool if not set\n"
+            "    --chunk <n>    chunk size in bytes, default 1048576\n");
+    }
+
+    bool ParseType(std::string_view name, dbflib::DB_INGEST_TYPE& type) {
+        if (name == "int64") {
+            type = dbflib::DBIT_INT64;
+        } else if (name == "double") {
+            type = dbflib::DBIT_DOUBLE;
+        } else if (name == "bool") {
+            type = dbflib::DBIT_BOOL;
+        } else if (name == "string") {
+            type = dbflib::DBIT_STRING;
+        } else {
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char const* argv[]) {
+    size_t threads = 0;
+    size_t chunk = 1 << 20;
+    int i = 1;
+    for (; i + 1 < argc && !std::strncmp(argv[i], "--", 2); i += 2) {
+        if (!std::strcmp(argv[i], "--threads")) {
+            threads = (size_t)std::strtoull(argv[i + 1], nullptr, 10);
+        } else if (!std::strcmp(argv[i], "--chunk")) {
+            chunk = (size_t)std::strtoull(argv[i + 1], nullptr, 10);
+        } else {
+            Usage();
+            return 1;
+        }
+    }
+    if (argc - i < 4) {
+        Usage();
+        return 1;
+    }
+
+    dbflib::DB_INGEST_FORMAT format;
+    if (!std::strcmp(argv[i], "jsonl")) {
+        format = dbflib::DBIF_JSON_LINES;
+    } else if (!std::strcmp(argv[i], "csv")) {
+        format = dbflib::DBIF_CSV;
+    } else {
+        Usage();
+        return 1;
+    }
+    std::filesystem::path input{ argv[i + 1] };
+    std::filesystem::path output{ argv[i + 2] };
+
+    dbflib::DBIngestSchema schema{};
+    for (int c = i + 3; c < argc; c++) {
+        std::string_view column{ argv[c] };
+        size_t sep = column.rfind(':');
+        dbflib::DB_INGEST_TYPE type{};
+        if (sep == std::string_view::npos || !ParseType(column.substr(sep + 1), type)) {
+            std::fprintf(stderr, "invalid column '%s'\n", argv[c]);
+            Usage();
+            return 1;
+        }
+        schema.Add(std::string{ column.substr(0, sep) }, type);
+    }
+
+    try {
+        std::unique_ptr<dbflib::DBWorkStealingExecutor> pool{};
+        if (threads) {
+            pool = std::make_unique<dbflib::DBWorkStealingExecutor>(threads - 1);
+        }
+        dbflib::DBExecutor& executor = pool ? *pool : dbflib::DefaultExecutor();
+
+        auto start = std::chrono::steady_clock::now();
+        dbflib::DBIngester ingester{ std::move(schema), format, chunk };
+        ingester.IngestFile(input, output, executor);
+        std::chrono::duration<double> time = std::chrono::steady_clock::now() - start;
+
+        double mb = (double)std::filesystem::file_size(input) / (1 << 20);
+        std::printf("%llu records, %.2f MiB in %.3f s, %.2f MiB/s\n", (unsigned long long)ingester.RecordCount(), mb, time.count(), mb / time.count());
+    } catch (std::exception& e) {
+        std::fprintf(stderr, "can't ingest %s: %s\n", input.string().c_str(), e.what());
+        return 1;
+    }
+    return 0;
+}